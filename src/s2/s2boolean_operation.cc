@@ -71,6 +71,7 @@
 
 #include "s2/util/gtl/btree_map.h"
 #include "s2/third_party/absl/memory/memory.h"
+#include "s2/mutable_s2shape_index.h"
 #include "s2/s2builder.h"
 #include "s2/s2builder_layer.h"
 #include "s2/s2builderutil_snap_functions.h"
@@ -81,6 +82,7 @@
 #include "s2/s2measures.h"
 #include "s2/s2predicates.h"
 #include "s2/s2shape_index_measures.h"
+#include "s2/s2shapeutil_range_iterator.h"
 #include "s2/s2shapeutil_visit_crossing_edge_pairs.h"
 
 // TODO(ericv): Remove this debugging output at some point.
@@ -800,6 +802,87 @@ void EdgeClippingLayer::Build(const Graph& g, S2Error* error) {
   }
 }
 
+// Compares the cells of two S2ShapeIndexes in order to quickly decide some
+// of the relationships between the two regions.  This works because the
+// index cells of each region cover all of its geometry, and a cell where
+// some polygon has no edges but contains the cell center ("full" cell) is
+// entirely contained by the interior of that polygon (since the cell is
+// padded slightly when deciding which edges intersect it).  The cells are
+// visited using a merge join that walks both cell sequences in order,
+// seeking past runs of cells in one index that do not overlap the other.
+// The cost is therefore at most linear in the total number of cells, and
+// the comparison stops as soon as no relationship can hold.
+class IndexCellRelation {
+ public:
+  IndexCellRelation(const S2ShapeIndex& a, const S2ShapeIndex& b);
+
+  // Returns true if no cell of "a" overlaps any cell of "b", which implies
+  // that the two regions have no points in common.
+  bool disjoint() const { return disjoint_; }
+
+  // Returns true if every cell of "a" is contained by a full cell of "b",
+  // which implies that "a" is contained by the interior of "b".
+  bool a_in_b_interior() const { return a_in_full_b_; }
+
+  // Returns true if every cell of "b" is contained by a full cell of "a".
+  bool b_in_a_interior() const { return b_in_full_a_; }
+
+ private:
+  static bool IsFull(const S2ShapeIndexCell& cell);
+
+  bool disjoint_ = true;
+  bool a_in_full_b_ = true;
+  bool b_in_full_a_ = true;
+};
+
+IndexCellRelation::IndexCellRelation(const S2ShapeIndex& a,
+                                     const S2ShapeIndex& b) {
+  s2shapeutil::RangeIterator ai(a), bi(b);
+  while (!ai.done() && !bi.done()) {
+    if (!disjoint_ && !a_in_full_b_ && !b_in_full_a_) return;
+    if (ai.range_max() < bi.range_min()) {
+      // The current "a" cell does not overlap any cell of "b", and neither
+      // do any other "a" cells that precede the current "b" cell.
+      a_in_full_b_ = false;
+      ai.SeekTo(bi.range_min());
+    } else if (bi.range_max() < ai.range_min()) {
+      b_in_full_a_ = false;
+      bi.SeekTo(ai.range_min());
+    } else {
+      // The two cells overlap, so one contains the other.
+      disjoint_ = false;
+      if (ai.range_min() <= bi.range_min() &&
+          ai.range_max() >= bi.range_max()) {
+        // The "b" cell is contained by the "a" cell.  If the containment is
+        // strict then the "a" cell is not contained by any "b" cell.
+        if (!IsFull(ai.cell())) b_in_full_a_ = false;
+        if (ai.id() == bi.id()) {
+          if (!IsFull(bi.cell())) a_in_full_b_ = false;
+          ai.Next();
+        } else {
+          a_in_full_b_ = false;
+        }
+        bi.Next();
+      } else {
+        // The "a" cell is strictly contained by the "b" cell.
+        if (!IsFull(bi.cell())) a_in_full_b_ = false;
+        b_in_full_a_ = false;
+        ai.Next();
+      }
+    }
+  }
+  if (!ai.done()) a_in_full_b_ = false;
+  if (!bi.done()) b_in_full_a_ = false;
+}
+
+bool IndexCellRelation::IsFull(const S2ShapeIndexCell& cell) {
+  for (int s = 0; s < cell.num_clipped(); ++s) {
+    const S2ClippedShape& clipped = cell.clipped(s);
+    if (clipped.contains_center() && clipped.num_edges() == 0) return true;
+  }
+  return false;
+}
+
 }  // namespace
 
 class S2BooleanOperation::Impl {
@@ -2382,10 +2465,41 @@ bool S2BooleanOperation::Build(const S2ShapeIndex& a,
 bool S2BooleanOperation::IsEmpty(
     OpType op_type, const S2ShapeIndex& a, const S2ShapeIndex& b,
     const Options& options) {
-  bool result_empty;
-  S2BooleanOperation op(op_type, &result_empty, options);
-  S2Error error;
-  op.Build(a, b, &error);
-  S2_DCHECK(error.ok());
-  return result_empty;
+  auto is_empty = [&options](OpType op_type, const S2ShapeIndex& a,
+                             const S2ShapeIndex& b) {
+    bool result_empty;
+    S2BooleanOperation op(op_type, &result_empty, options);
+    S2Error error;
+    op.Build(a, b, &error);
+    S2_DCHECK(error.ok());
+    return result_empty;
+  };
+  // Returns true if the region "x" is empty.  This is fast because the
+  // boolean output mode stops as soon as the first output edge is found.
+  auto is_region_empty = [&is_empty](const S2ShapeIndex& x) {
+    MutableS2ShapeIndex empty;
+    return is_empty(OpType::DIFFERENCE, x, empty);
+  };
+
+  // The result of a UNION can only be empty if both regions are empty, which
+  // the index cell comparison below does not help to decide.
+  if (op_type == OpType::UNION) return is_empty(op_type, a, b);
+
+  // Many common predicates (e.g., a small region tested against a large
+  // one) can be decided by comparing the index cells of the two regions,
+  // which avoids setting up the full edge clipping machinery.
+  IndexCellRelation relation(a, b);
+  if (op_type == OpType::INTERSECTION) {
+    if (relation.disjoint()) return true;
+    if (relation.a_in_b_interior()) return is_region_empty(a);
+    if (relation.b_in_a_interior()) return is_region_empty(b);
+  } else if (op_type == OpType::DIFFERENCE) {
+    if (relation.disjoint()) return is_region_empty(a);
+    if (relation.a_in_b_interior()) return true;
+  } else if (op_type == OpType::SYMMETRIC_DIFFERENCE) {
+    if (relation.disjoint()) {
+      return is_region_empty(a) && is_region_empty(b);
+    }
+  }
+  return is_empty(op_type, a, b);
 }
@@ -30,7 +30,10 @@
 #include "s2/s2builderutil_s2point_vector_layer.h"
 #include "s2/s2builderutil_s2polyline_vector_layer.h"
 #include "s2/s2builderutil_snap_functions.h"
+#include "s2/s2cap.h"
+#include "s2/s2loop.h"
 #include "s2/s2polygon.h"
+#include "s2/s2testing.h"
 #include "s2/s2text_format.h"
 
 namespace {
@@ -1398,3 +1401,45 @@ TEST(S2BooleanOperation, IntersectsEmptyAndFull) {
   EXPECT_FALSE(S2BooleanOperation::Intersects(*full, *empty));
   EXPECT_TRUE(S2BooleanOperation::Intersects(*full, *full));
 }
+
+// Returns an index containing a single polygon (owned by the index).
+static unique_ptr<MutableS2ShapeIndex> MakePolygonIndex(
+    unique_ptr<S2Polygon> polygon) {
+  auto index = make_unique<MutableS2ShapeIndex>();
+  index->Add(make_unique<S2Polygon::OwningShape>(std::move(polygon)));
+  return index;
+}
+
+TEST(S2BooleanOperation, SmallRegionPredicatesMatchS2Polygon) {
+  // Tests small loops against a large polygon with many edges.  This
+  // exercises the predicates that are decided using only the index cells
+  // (a small loop far from the large polygon, or entirely within its
+  // interior) as well as the general case.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(3000);
+  fractal.set_fractal_dimension(1.5);
+  Matrix3x3_d frame = S2Testing::GetRandomFrame();
+  S2Polygon large(fractal.MakeLoop(frame, S1Angle::Degrees(10)));
+  MutableS2ShapeIndex large_index;
+  large_index.Add(make_unique<S2Polygon::Shape>(&large));
+  S2Cap cap(frame.Col(2), S1Angle::Degrees(20));
+  for (int iter = 0; iter < 200; ++iter) {
+    auto small = make_unique<S2Polygon>(S2Loop::MakeRegularLoop(
+        S2Testing::SamplePoint(cap),
+        S1Angle::Degrees(0.5 * S2Testing::rnd.RandDouble()), 8));
+    bool intersects = large.Intersects(small.get());
+    bool contains = large.Contains(small.get());
+    bool contained = small->Contains(&large);
+    auto small_index = MakePolygonIndex(std::move(small));
+    EXPECT_EQ(intersects,
+              S2BooleanOperation::Intersects(large_index, *small_index));
+    EXPECT_EQ(intersects,
+              S2BooleanOperation::Intersects(*small_index, large_index));
+    EXPECT_EQ(contains,
+              S2BooleanOperation::Contains(large_index, *small_index));
+    EXPECT_EQ(contained,
+              S2BooleanOperation::Contains(*small_index, large_index));
+    EXPECT_FALSE(S2BooleanOperation::Equals(large_index, *small_index));
+  }
+}
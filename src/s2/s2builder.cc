@@ -489,6 +489,11 @@ void S2Builder::Reset() {
   label_set_modified_ = false;
   sites_.clear();
   edge_sites_.clear();
+  // Clear the per-layer vectors individually so that their memory is
+  // retained (see BuildLayers).
+  for (auto& edges : layer_edges_) edges.clear();
+  for (auto& input_edge_ids : layer_input_edge_ids_) input_edge_ids.clear();
+  input_edge_id_set_lexicon_.Clear();
   snapping_needed_ = false;
 }
 
@@ -1049,18 +1054,21 @@ void S2Builder::SnapEdge(InputEdgeId e, vector<SiteId>* chain) const {
 void S2Builder::BuildLayers() {
   // Each output edge has an "input edge id set id" (an int32) representing
   // the set of input edge ids that were snapped to this edge.  The actual
-  // InputEdgeIds can be retrieved using "input_edge_id_set_lexicon".
-  vector<vector<Edge>> layer_edges;
-  vector<vector<InputEdgeIdSetId>> layer_input_edge_ids;
-  IdSetLexicon input_edge_id_set_lexicon;
-  BuildLayerEdges(&layer_edges, &layer_input_edge_ids,
-                  &input_edge_id_set_lexicon);
+  // InputEdgeIds can be retrieved using "input_edge_id_set_lexicon_".
+  BuildLayerEdges(&layer_edges_, &layer_input_edge_ids_,
+                  &input_edge_id_set_lexicon_);
 
   // At this point we have no further need for the input geometry or nearby
-  // site data, so we clear those fields to save space.
-  vector<S2Point>().swap(input_vertices_);
-  vector<InputEdge>().swap(input_edges_);
-  vector<compact_array<SiteId>>().swap(edge_sites_);
+  // site data.  For large inputs we free this memory now in order to reduce
+  // peak memory usage; otherwise it is kept so that it can be reused by the
+  // next call to Build() (see Reset).
+  static const int kMaxInputEdgesToRetainMemory = 10000;
+  bool release_memory = input_edges_.size() > kMaxInputEdgesToRetainMemory;
+  if (release_memory) {
+    vector<S2Point>().swap(input_vertices_);
+    vector<InputEdge>().swap(input_edges_);
+    vector<compact_array<SiteId>>().swap(edge_sites_);
+  }
 
   // If there are a large number of layers, then we build a minimal subset of
   // vertices for each layer.  This ensures that layer types that iterate over
@@ -1080,7 +1088,7 @@ void S2Builder::BuildLayers() {
       vector<Graph::VertexId> filter_tmp;  // Temporary used by FilterVertices.
       layer_vertices.resize(layers_.size());
       for (int i = 0; i < layers_.size(); ++i) {
-        layer_vertices[i] = Graph::FilterVertices(sites_, &layer_edges[i],
+        layer_vertices[i] = Graph::FilterVertices(sites_, &layer_edges_[i],
                                                   &filter_tmp);
       }
       vector<S2Point>().swap(sites_);  // Release memory
@@ -1089,14 +1097,19 @@ void S2Builder::BuildLayers() {
   for (int i = 0; i < layers_.size(); ++i) {
     const vector<S2Point>& vertices = (layer_vertices.empty() ?
                                        sites_ : layer_vertices[i]);
-    Graph graph(layer_options_[i], &vertices, &layer_edges[i],
-                &layer_input_edge_ids[i], &input_edge_id_set_lexicon,
+    Graph graph(layer_options_[i], &vertices, &layer_edges_[i],
+                &layer_input_edge_ids_[i], &input_edge_id_set_lexicon_,
                 &label_set_ids_, &label_set_lexicon_,
                 layer_is_full_polygon_predicates_[i]);
     layers_[i]->Build(graph, error_);
     // Don't free the layer data until all layers have been built, in order to
     // support building multiple layers at once (e.g. ClosedSetNormalizer).
   }
+  if (release_memory) {
+    vector<vector<Edge>>().swap(layer_edges_);
+    vector<vector<InputEdgeIdSetId>>().swap(layer_input_edge_ids_);
+    input_edge_id_set_lexicon_ = IdSetLexicon();
+  }
 }
 
 static void DumpEdges(const vector<S2Builder::Graph::Edge>& edges,
@@ -565,7 +565,9 @@ class S2Builder {
   bool Build(S2Error* error);
 
   // Clears all input data and resets the builder state.  Any options
-  // specified are preserved.
+  // specified are preserved.  The memory used by small inputs is retained so
+  // that it can be reused by subsequent calls to Build(), which reduces the
+  // per-call overhead when one S2Builder is used for many small operations.
   void Reset();
 
  private:
@@ -761,6 +763,15 @@ class S2Builder {
   // the "sites to avoid" (needed for simplification).
   std::vector<gtl::compact_array<SiteId>> edge_sites_;
 
+  ////////////// Data for Building Layers //////////////
+
+  // The snapped edges for each layer and the corresponding sets of input
+  // edge ids.  These are only used during Build(); they are stored here
+  // (rather than as local variables) so that their memory can be reused.
+  std::vector<std::vector<Edge>> layer_edges_;
+  std::vector<std::vector<InputEdgeIdSetId>> layer_input_edge_ids_;
+  IdSetLexicon input_edge_id_set_lexicon_;
+
   S2Builder(const S2Builder&) = delete;
   S2Builder& operator=(const S2Builder&) = delete;
 };
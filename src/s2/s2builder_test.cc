@@ -1326,4 +1326,32 @@ TEST(S2Builder, OldS2PolygonBuilderBug) {
   ExpectPolygonsEqual(*expected, output);
 }
 
+TEST(S2Builder, ReuseAcrossBuilds) {
+  // Check that a single S2Builder produces the same output as a new S2Builder
+  // for each input, including after an input large enough that the builder
+  // releases its memory rather than retaining it.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S1Angle snap_radius = S1Angle::Degrees(0.01);
+  S2Builder::Options options{IdentitySnapFunction(snap_radius)};
+  options.set_split_crossing_edges(true);
+  S2Builder reused(options);
+  for (int iter = 0; iter < 50; ++iter) {
+    S2Testing::Fractal fractal;
+    fractal.SetLevelForApproxMaxEdges(iter == 20 ? 20000 : 30);
+    fractal.set_fractal_dimension(1.3);
+    auto loop = fractal.MakeLoop(S2Testing::GetRandomFrame(),
+                                 S1Angle::Degrees(1));
+    S2Polygon expected, actual;
+    S2Builder builder(options);
+    builder.StartLayer(make_unique<S2PolygonLayer>(&expected));
+    builder.AddLoop(*loop);
+    reused.StartLayer(make_unique<S2PolygonLayer>(&actual));
+    reused.AddLoop(*loop);
+    S2Error error;
+    ASSERT_TRUE(builder.Build(&error)) << error;
+    ASSERT_TRUE(reused.Build(&error)) << error;
+    ExpectPolygonsEqual(expected, actual);
+  }
+}
+
 }  // namespace
@@ -0,0 +1,120 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2caching_region.h"
+
+#include "s2/s2cap.h"
+#include "s2/s2cell.h"
+#include "s2/s2latlng_rect.h"
+
+using std::vector;
+
+S2CachingRegion::Options::Options() {
+}
+
+int S2CachingRegion::Options::max_cached_cells() const {
+  return max_cached_cells_;
+}
+
+void S2CachingRegion::Options::set_max_cached_cells(int max_cached_cells) {
+  max_cached_cells_ = max_cached_cells;
+}
+
+S2CachingRegion::S2CachingRegion(const S2Region* region,
+                                 const Options& options)
+    : region_(region), options_(options) {
+}
+
+int S2CachingRegion::num_cached_cells() const {
+  SpinLockHolder l(&lock_);
+  return cells_.size();
+}
+
+void S2CachingRegion::Clear() {
+  SpinLockHolder l(&lock_);
+  cells_.clear();
+  has_cell_union_bound_ = false;
+  cell_union_bound_.clear();
+}
+
+S2CachingRegion* S2CachingRegion::Clone() const {
+  return new S2CachingRegion(region_, options_);
+}
+
+S2Cap S2CachingRegion::GetCapBound() const {
+  return region_->GetCapBound();
+}
+
+S2LatLngRect S2CachingRegion::GetRectBound() const {
+  return region_->GetRectBound();
+}
+
+void S2CachingRegion::GetCellUnionBound(vector<S2CellId>* cell_ids) const {
+  {
+    SpinLockHolder l(&lock_);
+    if (has_cell_union_bound_) {
+      *cell_ids = cell_union_bound_;
+      return;
+    }
+  }
+  // The bound is computed without holding the lock, since it may be slow.
+  // If several threads do this at once they all compute the same result.
+  region_->GetCellUnionBound(cell_ids);
+  SpinLockHolder l(&lock_);
+  has_cell_union_bound_ = true;
+  cell_union_bound_ = *cell_ids;
+}
+
+inline uint8 S2CachingRegion::GetFlags(S2CellId id) const {
+  SpinLockHolder l(&lock_);
+  auto it = cells_.find(id);
+  return it == cells_.end() ? 0 : it->second;
+}
+
+void S2CachingRegion::AddFlags(S2CellId id, uint8 flags) const {
+  SpinLockHolder l(&lock_);
+  auto it = cells_.find(id);
+  if (it != cells_.end()) {
+    it->second |= flags;
+  } else if (cells_.size() < options_.max_cached_cells()) {
+    cells_.emplace(id, flags);
+  }
+}
+
+bool S2CachingRegion::Contains(const S2Cell& cell) const {
+  uint8 flags = GetFlags(cell.id());
+  if (flags & kContainsKnown) return flags & kContains;
+  // A region cannot contain a cell that it does not intersect.
+  if ((flags & kMayIntersectKnown) && !(flags & kMayIntersect)) return false;
+  bool contains = region_->Contains(cell);
+  // If the region contains the cell then it also intersects it.
+  AddFlags(cell.id(), contains ? (kContainsKnown | kContains |
+                                  kMayIntersectKnown | kMayIntersect)
+                               : kContainsKnown);
+  return contains;
+}
+
+bool S2CachingRegion::MayIntersect(const S2Cell& cell) const {
+  uint8 flags = GetFlags(cell.id());
+  if (flags & kMayIntersectKnown) return flags & kMayIntersect;
+  bool may_intersect = region_->MayIntersect(cell);
+  AddFlags(cell.id(), may_intersect ? (kMayIntersectKnown | kMayIntersect)
+                                    : (kMayIntersectKnown | kContainsKnown));
+  return may_intersect;
+}
+
+bool S2CachingRegion::Contains(const S2Point& p) const {
+  return region_->Contains(p);
+}
@@ -0,0 +1,128 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef S2_S2CACHING_REGION_H_
+#define S2_S2CACHING_REGION_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "s2/base/integral_types.h"
+#include "s2/base/spinlock.h"
+#include "s2/s2cell_id.h"
+#include "s2/s2region.h"
+#include "s2/util/hash/mix.h"
+
+class S2Cap;
+class S2Cell;
+class S2LatLngRect;
+
+// S2CachingRegion wraps another S2Region and remembers the results of
+// Contains(S2Cell) and MayIntersect(S2Cell) for each cell, so that they are
+// only computed once.  This is useful when the same region is covered many
+// times, e.g. with different S2RegionCoverer options:
+//
+//   S2CachingRegion region(&polygon);
+//   for (int max_cells : {8, 64, 512}) {
+//     coverer.mutable_options()->set_max_cells(max_cells);
+//     coverings.push_back(coverer.GetCovering(region));
+//   }
+//
+// Coverings with different options examine many of the same cells (in
+// particular the large cells near the top of the hierarchy), and for regions
+// such as S2Polygon each test requires querying an S2ShapeIndex.  The result
+// of GetCellUnionBound() is also cached.
+//
+// The wrapped region must not change while it is wrapped.  This class is
+// thread-safe, so a single S2CachingRegion can be covered by several threads
+// at once.
+class S2CachingRegion final : public S2Region {
+ public:
+  class Options {
+   public:
+    Options();
+
+    // The maximum number of cells whose results are cached.  Once the cache
+    // is full, results for further cells are computed but not stored.
+    // Since coverings are computed from the top down, the cached cells are
+    // the larger ones, which are the cells most likely to be shared by
+    // different coverings.  Each cell uses about 32 bytes.
+    //
+    // DEFAULT: 1 << 16
+    int max_cached_cells() const;
+    void set_max_cached_cells(int max_cached_cells);
+
+   private:
+    int max_cached_cells_ = 1 << 16;
+  };
+
+  // REQUIRES: "region" persists for the lifetime of this object.
+  explicit S2CachingRegion(const S2Region* region,
+                           const Options& options = Options());
+
+  const S2Region& region() const { return *region_; }
+  const Options& options() const { return options_; }
+
+  // Returns the number of cells whose results are cached.
+  int num_cached_cells() const;
+
+  // Discards all cached results.
+  void Clear();
+
+  ////////////////////////////////////////////////////////////////////////
+  // S2Region interface (see s2region.h for details):
+
+  // The clone wraps the same region but has an empty cache.
+  S2CachingRegion* Clone() const override;
+  S2Cap GetCapBound() const override;
+  S2LatLngRect GetRectBound() const override;
+  void GetCellUnionBound(std::vector<S2CellId>* cell_ids) const override;
+  bool Contains(const S2Cell& cell) const override;
+  bool MayIntersect(const S2Cell& cell) const override;
+  bool Contains(const S2Point& p) const override;
+
+ private:
+  // Bits recording which results are known for a cell, and their values.
+  enum : uint8 {
+    kContainsKnown = 1,
+    kContains = 2,
+    kMayIntersectKnown = 4,
+    kMayIntersect = 8,
+  };
+
+  struct CellIdHash {
+    size_t operator()(S2CellId id) const {
+      return HashMix(id.id()).get();
+    }
+  };
+
+  // Returns the known results for "id" (zero if none).
+  uint8 GetFlags(S2CellId id) const;
+
+  // Records the given results for "id", if there is room.
+  void AddFlags(S2CellId id, uint8 flags) const;
+
+  const S2Region* region_;
+  Options options_;
+
+  mutable SpinLock lock_;  // Protects the fields below.
+  mutable std::unordered_map<S2CellId, uint8, CellIdHash> cells_;
+  mutable bool has_cell_union_bound_ = false;
+  mutable std::vector<S2CellId> cell_union_bound_;
+
+  void operator=(const S2CachingRegion&) = delete;
+};
+
+#endif  // S2_S2CACHING_REGION_H_
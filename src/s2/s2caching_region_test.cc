@@ -0,0 +1,147 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2caching_region.h"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "s2/third_party/absl/memory/memory.h"
+#include "s2/s1angle.h"
+#include "s2/s2cap.h"
+#include "s2/s2cell.h"
+#include "s2/s2cell_union.h"
+#include "s2/s2latlng_rect.h"
+#include "s2/s2loop.h"
+#include "s2/s2polygon.h"
+#include "s2/s2region_coverer.h"
+#include "s2/s2testing.h"
+
+using absl::make_unique;
+using std::vector;
+
+namespace {
+
+// A region that counts the calls to Contains(S2Cell) and MayIntersect().
+class CountingRegion final : public S2Region {
+ public:
+  explicit CountingRegion(const S2Region* region) : region_(region) {}
+
+  int num_cell_calls() const { return num_cell_calls_; }
+
+  CountingRegion* Clone() const override {
+    return new CountingRegion(region_);
+  }
+  S2Cap GetCapBound() const override { return region_->GetCapBound(); }
+  S2LatLngRect GetRectBound() const override {
+    return region_->GetRectBound();
+  }
+  bool Contains(const S2Cell& cell) const override {
+    ++num_cell_calls_;
+    return region_->Contains(cell);
+  }
+  bool MayIntersect(const S2Cell& cell) const override {
+    ++num_cell_calls_;
+    return region_->MayIntersect(cell);
+  }
+  bool Contains(const S2Point& p) const override {
+    return region_->Contains(p);
+  }
+
+ private:
+  const S2Region* region_;
+  mutable std::atomic<int> num_cell_calls_{0};
+};
+
+std::unique_ptr<S2Polygon> MakeFractalPolygon() {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(1000);
+  return make_unique<S2Polygon>(fractal.MakeLoop(
+      S2Testing::GetRandomFrameAt(S2Testing::RandomPoint()),
+      S1Angle::Degrees(10)));
+}
+
+// Returns the coverings and interior coverings of "region" for several
+// values of max_cells.
+vector<S2CellUnion> GetCoverings(const S2Region& region) {
+  vector<S2CellUnion> coverings;
+  S2RegionCoverer coverer;
+  for (int max_cells : {8, 64, 512}) {
+    coverer.mutable_options()->set_max_cells(max_cells);
+    coverings.push_back(coverer.GetCovering(region));
+    coverings.push_back(coverer.GetInteriorCovering(region));
+  }
+  return coverings;
+}
+
+TEST(S2CachingRegion, CoveringsMatchWrappedRegion) {
+  auto polygon = MakeFractalPolygon();
+  CountingRegion counting(polygon.get());
+  S2CachingRegion region(&counting);
+  vector<S2CellUnion> expected = GetCoverings(*polygon);
+  EXPECT_EQ(expected, GetCoverings(region));
+  EXPECT_GT(region.num_cached_cells(), 0);
+
+  // The second time, every result comes from the cache.
+  int num_calls = counting.num_cell_calls();
+  EXPECT_EQ(expected, GetCoverings(region));
+  EXPECT_EQ(num_calls, counting.num_cell_calls());
+
+  // The same is true of GetCellUnionBound().
+  vector<S2CellId> expected_bound, bound;
+  counting.GetCellUnionBound(&expected_bound);
+  region.GetCellUnionBound(&bound);
+  EXPECT_EQ(expected_bound, bound);
+  region.GetCellUnionBound(&bound);
+  EXPECT_EQ(expected_bound, bound);
+
+  region.Clear();
+  EXPECT_EQ(0, region.num_cached_cells());
+  std::unique_ptr<S2CachingRegion> clone(region.Clone());
+  EXPECT_EQ(expected, GetCoverings(*clone));
+}
+
+TEST(S2CachingRegion, MaxCachedCells) {
+  auto polygon = MakeFractalPolygon();
+  S2CachingRegion::Options options;
+  options.set_max_cached_cells(10);
+  S2CachingRegion region(polygon.get(), options);
+  vector<S2CellUnion> expected = GetCoverings(*polygon);
+  EXPECT_EQ(expected, GetCoverings(region));
+  EXPECT_EQ(10, region.num_cached_cells());
+}
+
+TEST(S2CachingRegion, ConcurrentCoverings) {
+  auto polygon = MakeFractalPolygon();
+  S2CachingRegion region(polygon.get());
+  vector<S2CellUnion> expected = GetCoverings(*polygon);
+  vector<vector<S2CellUnion>> actual(3);
+  vector<std::thread> threads;
+  for (auto& coverings : actual) {
+    threads.emplace_back([&region, &coverings]() {
+        coverings = GetCoverings(region);
+      });
+  }
+  for (auto& thread : threads) thread.join();
+  for (const auto& coverings : actual) {
+    EXPECT_EQ(expected, coverings);
+  }
+}
+
+}  // namespace
@@ -301,18 +301,18 @@ bool S2Cell::Decode(Decoder* const decoder) {
   return true;
 }
 
-// Return the squared chord distance from point P to corner vertex (i,j).
-inline S1ChordAngle S2Cell::VertexChordDist(
-    const S2Point& p, int i, int j) const {
-  S2Point vertex = S2Point(uv_[0][i], uv_[1][j], 1).Normalize();
+// Return the squared chord distance from point P to the vertex (u,v).
+inline S1ChordAngle S2Cell::VertexChordDist(const S2Point& p,
+                                            double u, double v) {
+  S2Point vertex = S2Point(u, v, 1).Normalize();
   return S1ChordAngle(p, vertex);
 }
 
-// Given a point P and either the lower or upper edge of the S2Cell (specified
-// by setting "v_end" to 0 or 1 respectively), return true if P is closer to
-// the interior of that edge than it is to either endpoint.
-bool S2Cell::UEdgeIsClosest(const S2Point& p, int v_end) const {
-  double u0 = uv_[0][0], u1 = uv_[0][1], v = uv_[1][v_end];
+// Given a point P and either the lower or upper edge of the cell with bounds
+// "uv" (specified by setting "v_end" to 0 or 1 respectively), return true if
+// P is closer to the interior of that edge than it is to either endpoint.
+bool S2Cell::UEdgeIsClosest(const S2Point& p, const R2Rect& uv, int v_end) {
+  double u0 = uv[0][0], u1 = uv[0][1], v = uv[1][v_end];
   // These are the normals to the planes that are perpendicular to the edge
   // and pass through one of its two endpoints.
   S2Point dir0(v * v + 1, -u0 * v, -u0);
@@ -320,11 +320,11 @@ bool S2Cell::UEdgeIsClosest(const S2Point& p, int v_end) const {
   return p.DotProd(dir0) > 0 && p.DotProd(dir1) < 0;
 }
 
-// Given a point P and either the left or right edge of the S2Cell (specified
-// by setting "u_end" to 0 or 1 respectively), return true if P is closer to
-// the interior of that edge than it is to either endpoint.
-bool S2Cell::VEdgeIsClosest(const S2Point& p, int u_end) const {
-  double v0 = uv_[1][0], v1 = uv_[1][1], u = uv_[0][u_end];
+// Given a point P and either the left or right edge of the cell with bounds
+// "uv" (specified by setting "u_end" to 0 or 1 respectively), return true if
+// P is closer to the interior of that edge than it is to either endpoint.
+bool S2Cell::VEdgeIsClosest(const S2Point& p, const R2Rect& uv, int u_end) {
+  double v0 = uv[1][0], v1 = uv[1][1], u = uv[0][u_end];
   // See comments above.
   S2Point dir0(-u * v0, u * u + 1, -v0);
   S2Point dir1(-u * v1, u * u + 1, -v1);
@@ -355,29 +355,34 @@ S1ChordAngle S2Cell::GetDistanceInternal(const S2Point& target_xyz,
   S2Point target = S2::FaceXYZtoUVW(face_, target_xyz);
 
   // Compute dot products with all four upward or rightward-facing edge
-  // normals.  "dirIJ" is the dot product for the edge corresponding to axis
-  // I, endpoint J.  For example, dir01 is the right edge of the S2Cell
-  // (corresponding to the upper endpoint of the u-axis).
-  double dir00 = target[0] - target[2] * uv_[0][0];
-  double dir01 = target[0] - target[2] * uv_[0][1];
-  double dir10 = target[1] - target[2] * uv_[1][0];
-  double dir11 = target[1] - target[2] * uv_[1][1];
+  // normals.  For example, dir_u[1] is the dot product for the right edge of
+  // the S2Cell (corresponding to the upper endpoint of the u-axis).
+  double dir_u[2] = {target[0] - target[2] * uv_[0][0],
+                     target[0] - target[2] * uv_[0][1]};
+  double dir_v[2] = {target[1] - target[2] * uv_[1][0],
+                     target[1] - target[2] * uv_[1][1]};
+  return GetUVDistance(target, uv_, dir_u, dir_v, to_interior);
+}
+
+S1ChordAngle S2Cell::GetUVDistance(const S2Point& target, const R2Rect& uv,
+                                   const double dir_u[2],
+                                   const double dir_v[2], bool to_interior) {
   bool inside = true;
-  if (dir00 < 0) {
+  if (dir_u[0] < 0) {
     inside = false;  // Target is to the left of the cell
-    if (VEdgeIsClosest(target, 0)) return EdgeDistance(-dir00, uv_[0][0]);
+    if (VEdgeIsClosest(target, uv, 0)) return EdgeDistance(-dir_u[0], uv[0][0]);
   }
-  if (dir01 > 0) {
+  if (dir_u[1] > 0) {
     inside = false;  // Target is to the right of the cell
-    if (VEdgeIsClosest(target, 1)) return EdgeDistance(dir01, uv_[0][1]);
+    if (VEdgeIsClosest(target, uv, 1)) return EdgeDistance(dir_u[1], uv[0][1]);
   }
-  if (dir10 < 0) {
+  if (dir_v[0] < 0) {
     inside = false;  // Target is below the cell
-    if (UEdgeIsClosest(target, 0)) return EdgeDistance(-dir10, uv_[1][0]);
+    if (UEdgeIsClosest(target, uv, 0)) return EdgeDistance(-dir_v[0], uv[1][0]);
   }
-  if (dir11 > 0) {
+  if (dir_v[1] > 0) {
     inside = false;  // Target is above the cell
-    if (UEdgeIsClosest(target, 1)) return EdgeDistance(dir11, uv_[1][1]);
+    if (UEdgeIsClosest(target, uv, 1)) return EdgeDistance(dir_v[1], uv[1][1]);
   }
   if (inside) {
     if (to_interior) return S1ChordAngle::Zero();
@@ -385,20 +390,20 @@ S1ChordAngle S2Cell::GetDistanceInternal(const S2Point& target_xyz,
     // arbitrary quadrilaterals after they are projected onto the sphere.
     // Therefore the simplest approach is just to find the minimum distance to
     // any of the four edges.
-    return min(min(EdgeDistance(-dir00, uv_[0][0]),
-                   EdgeDistance(dir01, uv_[0][1])),
-               min(EdgeDistance(-dir10, uv_[1][0]),
-                   EdgeDistance(dir11, uv_[1][1])));
+    return min(min(EdgeDistance(-dir_u[0], uv[0][0]),
+                   EdgeDistance(dir_u[1], uv[0][1])),
+               min(EdgeDistance(-dir_v[0], uv[1][0]),
+                   EdgeDistance(dir_v[1], uv[1][1])));
   }
   // Otherwise, the closest point is one of the four cell vertices.  Note that
   // it is *not* trivial to narrow down the candidates based on the edge sign
   // tests above, because (1) the edges don't meet at right angles and (2)
   // there are points on the far side of the sphere that are both above *and*
   // below the cell, etc.
-  return min(min(VertexChordDist(target, 0, 0),
-                 VertexChordDist(target, 1, 0)),
-             min(VertexChordDist(target, 0, 1),
-                 VertexChordDist(target, 1, 1)));
+  return min(min(VertexChordDist(target, uv[0][0], uv[1][0]),
+                 VertexChordDist(target, uv[0][1], uv[1][0])),
+             min(VertexChordDist(target, uv[0][0], uv[1][1]),
+                 VertexChordDist(target, uv[0][1], uv[1][1])));
 }
 
 S1ChordAngle S2Cell::GetDistance(const S2Point& target) const {
@@ -413,10 +418,11 @@ S1ChordAngle S2Cell::GetMaxDistance(const S2Point& target) const {
   // First check the 4 cell vertices.  If all are within the hemisphere
   // centered around target, the max distance will be to one of these vertices.
   S2Point target_uvw = S2::FaceXYZtoUVW(face_, target);
-  S1ChordAngle max_dist = max(max(VertexChordDist(target_uvw, 0, 0),
-                                         VertexChordDist(target_uvw, 1, 0)),
-                                     max(VertexChordDist(target_uvw, 0, 1),
-                                         VertexChordDist(target_uvw, 1, 1)));
+  S1ChordAngle max_dist =
+      max(max(VertexChordDist(target_uvw, uv_[0][0], uv_[1][0]),
+              VertexChordDist(target_uvw, uv_[0][1], uv_[1][0])),
+          max(VertexChordDist(target_uvw, uv_[0][0], uv_[1][1]),
+              VertexChordDist(target_uvw, uv_[0][1], uv_[1][1])));
 
   if (max_dist <= S1ChordAngle::Right()) {
     return max_dist;
@@ -427,6 +433,97 @@ S1ChordAngle S2Cell::GetMaxDistance(const S2Point& target) const {
   return S1ChordAngle::Straight() - GetDistance(-target);
 }
 
+// Returns the (u,v) bounds of the child at position "pos" of the cell with
+// the given orientation and bounds, where "mid" is the cell center in
+// (u,v)-space.  Also returns the index of the child's lower u- and
+// v-coordinates among {uv[0][0], mid[0], uv[0][1]} and {uv[1][0], mid[1],
+// uv[1][1]} respectively.  This mirrors the logic in Subdivide().
+inline static R2Rect GetChildUV(const R2Rect& uv, const R2Point& mid,
+                                int orientation, int pos, int* i, int* j) {
+  int ij = kPosToIJ[orientation][pos];
+  *i = ij >> 1;
+  *j = ij & 1;
+  R2Rect child;
+  child[0][*i] = uv[0][*i];
+  child[0][1 - *i] = mid[0];
+  child[1][*j] = uv[1][*j];
+  child[1][1 - *j] = mid[1];
+  return child;
+}
+
+bool S2Cell::GetChildDistancesInternal(const S2Point& target_xyz,
+                                       bool to_interior,
+                                       S1ChordAngle distances[4]) const {
+  if (id_.is_leaf()) return false;
+
+  // The children share three u-coordinates and three v-coordinates, so we
+  // only need six edge normal dot products rather than sixteen.
+  S2Point target = S2::FaceXYZtoUVW(face_, target_xyz);
+  R2Point mid = id_.GetCenterUV();
+  double dir_u[3], dir_v[3];
+  dir_u[0] = target[0] - target[2] * uv_[0][0];
+  dir_u[1] = target[0] - target[2] * mid[0];
+  dir_u[2] = target[0] - target[2] * uv_[0][1];
+  dir_v[0] = target[1] - target[2] * uv_[1][0];
+  dir_v[1] = target[1] - target[2] * mid[1];
+  dir_v[2] = target[1] - target[2] * uv_[1][1];
+  for (int pos = 0; pos < 4; ++pos) {
+    int i, j;
+    R2Rect uv = GetChildUV(uv_, mid, orientation_, pos, &i, &j);
+    distances[pos] = GetUVDistance(target, uv, dir_u + i, dir_v + j,
+                                   to_interior);
+  }
+  return true;
+}
+
+bool S2Cell::GetChildDistances(const S2Point& target,
+                               S1ChordAngle distances[4]) const {
+  return GetChildDistancesInternal(target, true /*to_interior*/, distances);
+}
+
+bool S2Cell::GetChildBoundaryDistances(const S2Point& target,
+                                       S1ChordAngle distances[4]) const {
+  return GetChildDistancesInternal(target, false /*to_interior*/, distances);
+}
+
+bool S2Cell::GetChildMaxDistances(const S2Point& target,
+                                  S1ChordAngle distances[4]) const {
+  if (id_.is_leaf()) return false;
+
+  // The children share nine vertices, whose distances are computed once.
+  S2Point target_uvw = S2::FaceXYZtoUVW(face_, target);
+  R2Point mid = id_.GetCenterUV();
+  double u[3] = {uv_[0][0], mid[0], uv_[0][1]};
+  double v[3] = {uv_[1][0], mid[1], uv_[1][1]};
+  S1ChordAngle vertex_dist[3][3];
+  for (int a = 0; a < 3; ++a) {
+    for (int b = 0; b < 3; ++b) {
+      vertex_dist[a][b] = VertexChordDist(target_uvw, u[a], v[b]);
+    }
+  }
+  bool need_antipodal = false;
+  for (int pos = 0; pos < 4; ++pos) {
+    int i, j;
+    GetChildUV(uv_, mid, orientation_, pos, &i, &j);
+    // As in GetMaxDistance(), the order of the vertices is (0,0), (1,0),
+    // (0,1), (1,1).
+    distances[pos] = max(max(vertex_dist[i][j], vertex_dist[i + 1][j]),
+                         max(vertex_dist[i][j + 1], vertex_dist[i + 1][j + 1]));
+    if (distances[pos] > S1ChordAngle::Right()) need_antipodal = true;
+  }
+  if (need_antipodal) {
+    // See GetMaxDistance().
+    S1ChordAngle antipodal[4];
+    GetChildDistancesInternal(-target, true /*to_interior*/, antipodal);
+    for (int pos = 0; pos < 4; ++pos) {
+      if (distances[pos] > S1ChordAngle::Right()) {
+        distances[pos] = S1ChordAngle::Straight() - antipodal[pos];
+      }
+    }
+  }
+  return true;
+}
+
 S1ChordAngle S2Cell::GetDistance(const S2Point& a, const S2Point& b) const {
   // Possible optimizations:
   //  - Currently the (cell vertex, edge endpoint) distances are computed
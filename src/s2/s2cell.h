@@ -161,6 +161,24 @@ class S2Cell final : public S2Region {
   // given target cell.
   S1ChordAngle GetMaxDistance(const S2Cell& target) const;
 
+  // If this is not a leaf cell, sets distances[0..3] to the distance from
+  // each of the four children of this cell (in traversal order) to the given
+  // point and returns true.  Otherwise returns false.  This method is
+  // equivalent to calling Subdivide() and then GetDistance(target) for each
+  // child, except that it is faster because the children share the
+  // projection of "target" onto the cell face, their edge normals, and
+  // (for GetChildMaxDistances) their vertices.  The results are identical.
+  bool GetChildDistances(const S2Point& target,
+                         S1ChordAngle distances[4]) const;
+
+  // Like GetChildDistances(), but equivalent to GetBoundaryDistance().
+  bool GetChildBoundaryDistances(const S2Point& target,
+                                 S1ChordAngle distances[4]) const;
+
+  // Like GetChildDistances(), but equivalent to GetMaxDistance().
+  bool GetChildMaxDistances(const S2Point& target,
+                            S1ChordAngle distances[4]) const;
+
   ////////////////////////////////////////////////////////////////////////
   // S2Region interface (see s2region.h for details):
 
@@ -197,15 +215,30 @@ class S2Cell final : public S2Region {
   double GetLatitude(int i, int j) const;
   double GetLongitude(int i, int j) const;
 
-  S1ChordAngle VertexChordDist(const S2Point& p, int i, int j) const;
-  bool UEdgeIsClosest(const S2Point& target, int v_end) const;
-  bool VEdgeIsClosest(const S2Point& target, int u_end) const;
+  // The following methods are static so that they can be applied to the
+  // (u,v) bounds of child cells without constructing them.  Points are
+  // given in the (u,v,w) coordinates of the cell face.
+  static S1ChordAngle VertexChordDist(const S2Point& p, double u, double v);
+  static bool UEdgeIsClosest(const S2Point& target, const R2Rect& uv,
+                             int v_end);
+  static bool VEdgeIsClosest(const S2Point& target, const R2Rect& uv,
+                             int u_end);
 
   // Returns the distance from the given point to the interior of the cell if
   // "to_interior" is true, and to the boundary of the cell otherwise.
   S1ChordAngle GetDistanceInternal(const S2Point& target_xyz,
                                    bool to_interior) const;
 
+  // Like GetDistanceInternal(), but for the cell with bounds "uv".  "dir_u"
+  // contains the dot products of "target" with the normals of the edges at
+  // u == uv[0][0] and u == uv[0][1], and similarly for "dir_v".
+  static S1ChordAngle GetUVDistance(const S2Point& target, const R2Rect& uv,
+                                    const double dir_u[2],
+                                    const double dir_v[2], bool to_interior);
+
+  bool GetChildDistancesInternal(const S2Point& target_xyz, bool to_interior,
+                                 S1ChordAngle distances[4]) const;
+
   // This structure occupies 44 bytes plus one pointer for the vtable.
   int8 face_;
   int8 level_;
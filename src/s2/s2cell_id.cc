@@ -194,14 +194,7 @@ int S2CellId::GetCommonAncestorLevel(S2CellId other) const {
 }
 
 // Print the num_digits low order hex digits.
-static string HexFormatString(uint64 val, size_t num_digits) {
-  string result(num_digits, ' ');
-  for (; num_digits--; val >>= 4)
-    result[num_digits] = "0123456789abcdef"[val & 0xF];
-  return result;
-}
-
-string S2CellId::ToToken() const {
+int S2CellId::ToToken(char* token) const {
   // Simple implementation: print the id in hex without trailing zeros.
   // Using hex has the advantage that the tokens are case-insensitive, all
   // characters are alphanumeric, no characters require any special escaping
@@ -214,26 +207,66 @@ string S2CellId::ToToken() const {
 
   // "0" with trailing 0s stripped is the empty string, which is not a
   // reasonable token.  Encode as "X".
-  if (id_ == 0) return "X";
-  const size_t num_zero_digits = Bits::FindLSBSetNonZero64(id_) / 4;
-  return HexFormatString(id_ >> (4 * num_zero_digits), 16 - num_zero_digits);
+  if (id_ == 0) {
+    token[0] = 'X';
+    return 1;
+  }
+  const int num_zero_digits = Bits::FindLSBSetNonZero64(id_) / 4;
+  const int num_digits = 16 - num_zero_digits;
+  uint64 val = id_ >> (4 * num_zero_digits);
+  for (int i = num_digits; i-- > 0; val >>= 4) {
+    token[i] = "0123456789abcdef"[val & 0xF];
+  }
+  return num_digits;
+}
+
+string S2CellId::ToToken() const {
+  char token[kMaxTokenLength];
+  return string(token, ToToken(token));
+}
+
+void S2CellId::ToTokens(absl::Span<const S2CellId> ids, vector<char>* buffer,
+                        vector<absl::string_view>* tokens) {
+  // Write the tokens into a buffer that is large enough for the longest
+  // possible tokens, and then trim it.  Since trimming does not reallocate,
+  // the tokens remain valid.
+  buffer->resize(ids.size() * kMaxTokenLength);
+  tokens->resize(ids.size());
+  char* data = buffer->data();
+  size_t pos = 0;
+  for (int k = 0; k < ids.size(); ++k) {
+    int length = ids[k].ToToken(data + pos);
+    (*tokens)[k] = absl::string_view(data + pos, length);
+    pos += length;
+  }
+  buffer->resize(pos);
 }
 
+namespace {
+
+// Maps each character to the value of the corresponding hexadecimal digit,
+// or -1 if the character is not a hexadecimal digit.
+struct HexDigitTable {
+  HexDigitTable() {
+    std::fill(value, value + 256, -1);
+    for (int i = 0; i < 10; ++i) value['0' + i] = i;
+    for (int i = 0; i < 6; ++i) {
+      value['a' + i] = value['A' + i] = 10 + i;
+    }
+  }
+  int8 value[256];
+};
+
+}  // namespace
+
 S2CellId S2CellId::FromToken(const char* token, size_t length) {
-  if (length > 16) return S2CellId::None();
+  static const HexDigitTable kHexDigits;
+  if (length > kMaxTokenLength) return S2CellId::None();
   uint64 id = 0;
   for (int i = 0, pos = 60; i < length; ++i, pos -= 4) {
-    uint64 d;
-    if ('0' <= token[i] && token[i] <= '9') {
-      d = token[i] - '0';
-    } else if ('a' <= token[i] && token[i] <= 'f') {
-      d = token[i] - 'a' + 10;
-    } else if ('A' <= token[i] && token[i] <= 'F') {
-      d = token[i] - 'A' + 10;
-    } else {
-      return S2CellId::None();
-    }
-    id |= d << pos;
+    int d = kHexDigits.value[static_cast<unsigned char>(token[i])];
+    if (d < 0) return S2CellId::None();
+    id |= static_cast<uint64>(d) << pos;
   }
   return S2CellId(id);
 }
@@ -242,6 +275,14 @@ S2CellId S2CellId::FromToken(const string& token) {
   return FromToken(token.data(), token.size());
 }
 
+void S2CellId::FromTokens(absl::Span<const absl::string_view> tokens,
+                          vector<S2CellId>* ids) {
+  ids->resize(tokens.size());
+  for (int k = 0; k < tokens.size(); ++k) {
+    (*ids)[k] = FromToken(tokens[k].data(), tokens[k].size());
+  }
+}
+
 void S2CellId::Encode(Encoder* const encoder) const {
   encoder->Ensure(sizeof(uint64));  // A single uint64.
   encoder->put64(id_);
@@ -501,6 +542,45 @@ void S2CellId::GetEdgeNeighbors(S2CellId neighbors[4]) const {
                  .parent(level);
 }
 
+void S2CellId::GetEdgeNeighbors(absl::Span<const S2CellId> ids,
+                                vector<S2CellId>* neighbors) {
+  // The offsets from a cell to its neighbors in the order returned by
+  // GetEdgeNeighbors(), in units of the cell size.
+  static const int kOffsetI[4] = {0, 1, 0, -1};
+  static const int kOffsetJ[4] = {-1, 0, 1, 0};
+
+  neighbors->resize(4 * ids.size());
+  int face = 0, i = 0, j = 0;
+  for (int k = 0; k < ids.size(); ++k) {
+    S2CellId id = ids[k];
+    int level = id.level();
+    int size = GetSizeIJ(level);
+    S2CellId* nbrs = &(*neighbors)[4 * k];
+    // If this cell is a same-face neighbor of the previous cell, we can
+    // compute its coordinates by offsetting the previous ones.
+    bool found = false;
+    if (k > 0 && ids[k - 1].level() == level) {
+      for (int d = 0; d < 4; ++d) {
+        int ni = i + kOffsetI[d] * size, nj = j + kOffsetJ[d] * size;
+        if (nbrs[d - 4] == id && ni >= 0 && ni < kMaxSize &&
+            nj >= 0 && nj < kMaxSize) {
+          i = ni;
+          j = nj;
+          found = true;
+          break;
+        }
+      }
+    }
+    if (!found) face = id.ToFaceIJOrientation(&i, &j, nullptr);
+    nbrs[0] = FromFaceIJSame(face, i, j - size, j - size >= 0).parent(level);
+    nbrs[1] = FromFaceIJSame(face, i + size, j, i + size < kMaxSize)
+              .parent(level);
+    nbrs[2] = FromFaceIJSame(face, i, j + size, j + size < kMaxSize)
+              .parent(level);
+    nbrs[3] = FromFaceIJSame(face, i - size, j, i - size >= 0).parent(level);
+  }
+}
+
 void S2CellId::AppendVertexNeighbors(int level,
                                      vector<S2CellId>* output) const {
   // "level" must be strictly less than this cell's level so that we can
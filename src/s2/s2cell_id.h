@@ -33,6 +33,7 @@
 #include "s2/s1angle.h"
 #include "s2/s2coords.h"
 #include "s2/third_party/absl/strings/string_view.h"
+#include "s2/third_party/absl/types/span.h"
 #include "s2/util/bits/bits.h"
 #include "s2/util/coding/coder.h"
 
@@ -85,6 +86,7 @@ class S2CellId {
   static const int kMaxLevel = S2::kMaxCellLevel;  // Valid levels: 0..kMaxLevel
   static const int kPosBits = 2 * kMaxLevel + 1;
   static const int kMaxSize = 1 << kMaxLevel;
+  static const int kMaxTokenLength = 16;  // See ToToken().
 
   explicit IFNDEF_SWIG(constexpr) S2CellId(uint64 id) : id_(id) {}
 
@@ -366,6 +368,24 @@ class S2CellId {
   static S2CellId FromToken(const char* token, size_t length);
   static S2CellId FromToken(const std::string& token);
 
+  // Like ToToken(), but writes the token to "token" rather than allocating a
+  // string, and returns its length (at most kMaxTokenLength).  No
+  // terminating NUL character is written.
+  int ToToken(char* token) const;
+
+  // Converts each cell id in "ids" to a token.  The tokens are stored
+  // consecutively in "buffer" and (*tokens)[k] refers to the token for
+  // ids[k], so "buffer" must not be modified or destroyed while "tokens" is
+  // in use.  Both vectors are overwritten, and memory is allocated only when
+  // they need to grow.
+  static void ToTokens(absl::Span<const S2CellId> ids,
+                       std::vector<char>* buffer,
+                       std::vector<absl::string_view>* tokens);
+
+  // Sets (*ids)[k] to FromToken(tokens[k]) for each of the given tokens.
+  static void FromTokens(absl::Span<const absl::string_view> tokens,
+                         std::vector<S2CellId>* ids);
+
   // Use encoder to generate a serialized representation of this cell id.
   // Can also encode an invalid cell.
   void Encode(Encoder* const encoder) const;
@@ -395,6 +415,15 @@ class S2CellId {
   // neighbors are guaranteed to be distinct.
   void GetEdgeNeighbors(S2CellId neighbors[4]) const;
 
+  // Sets (*neighbors)[4 * k + d] to neighbor "d" of ids[k], as returned by
+  // GetEdgeNeighbors().  This is faster than calling GetEdgeNeighbors() for
+  // each cell when consecutive cells are adjacent, as is typical for sorted
+  // cells at the same level (e.g. a range of cells along the Hilbert curve),
+  // since the (i,j) coordinates of each such cell are obtained from its
+  // predecessor rather than by decoding the cell id.
+  static void GetEdgeNeighbors(absl::Span<const S2CellId> ids,
+                               std::vector<S2CellId>* neighbors);
+
   // Return the neighbors of closest vertex to this cell at the given level,
   // by appending them to "output".  Normally there are four neighbors, but
   // the closest vertex may only have three neighbors if it is one of the 8
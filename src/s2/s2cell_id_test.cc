@@ -317,6 +317,40 @@ TEST(S2CellId, Tokens) {
   EXPECT_EQ(S2CellId::None(), S2CellId::FromToken(" 876bee99"));
 }
 
+// Returns a cell id at an arbitrary position and level, without consuming
+// random numbers (which would change the cells chosen by later tests).
+static S2CellId GetScatteredCellId(int i) {
+  return S2CellId::FromFacePosLevel(i % S2CellId::kNumFaces,
+                                    (i * 0x9e3779b97f4a7c15ULL) >> 3,
+                                    i % (S2CellId::kMaxLevel + 1));
+}
+
+TEST(S2CellId, BatchTokens) {
+  vector<S2CellId> ids = {S2CellId::None(), S2CellId::Sentinel(),
+                          S2CellId::FromFace(7)};
+  for (int i = 0; i < 1000; ++i) {
+    ids.push_back(GetScatteredCellId(i));
+  }
+  vector<char> buffer;
+  vector<absl::string_view> tokens;
+  S2CellId::ToTokens(ids, &buffer, &tokens);
+  ASSERT_EQ(ids.size(), tokens.size());
+  for (int k = 0; k < ids.size(); ++k) {
+    EXPECT_EQ(ids[k].ToToken(), string(tokens[k]));
+    char token[S2CellId::kMaxTokenLength];
+    int length = ids[k].ToToken(token);
+    EXPECT_EQ(ids[k].ToToken(), string(token, length));
+  }
+  vector<S2CellId> decoded;
+  S2CellId::FromTokens(tokens, &decoded);
+  EXPECT_EQ(ids, decoded);
+
+  // Malformed tokens decode to S2CellId::None().
+  vector<absl::string_view> invalid = {"876b e99", "g", "12345678901234567"};
+  S2CellId::FromTokens(invalid, &decoded);
+  EXPECT_EQ(vector<S2CellId>(3, S2CellId::None()), decoded);
+}
+
 TEST(S2CellId, EncodeDecode) {
   S2CellId id(0x7837423);
   Encoder encoder;
@@ -533,6 +567,37 @@ TEST(S2CellId, Neighbors) {
   }
 }
 
+TEST(S2CellId, BatchEdgeNeighbors) {
+  // Check consecutive cells along the Hilbert curve (including ranges that
+  // cross face boundaries) as well as random cells.
+  vector<S2CellId> ids;
+  for (int level : {0, 1, 5, 12, S2CellId::kMaxLevel}) {
+    S2CellId id = S2CellId::Begin(level);
+    for (int i = 0; i < 100; ++i) {
+      ids.push_back(id);
+      id = id.advance_wrap(1);
+    }
+    id = S2CellId::FromFace(1).range_min().parent(level).advance_wrap(-50);
+    for (int i = 0; i < 100; ++i) {
+      ids.push_back(id);
+      id = id.advance_wrap(1);
+    }
+  }
+  for (int i = 0; i < 1000; ++i) {
+    ids.push_back(GetScatteredCellId(i));
+  }
+  vector<S2CellId> neighbors;
+  S2CellId::GetEdgeNeighbors(ids, &neighbors);
+  ASSERT_EQ(4 * ids.size(), neighbors.size());
+  for (int k = 0; k < ids.size(); ++k) {
+    S2CellId expected[4];
+    ids[k].GetEdgeNeighbors(expected);
+    for (int d = 0; d < 4; ++d) {
+      EXPECT_EQ(expected[d], neighbors[4 * k + d]);
+    }
+  }
+}
+
 // Returns a random point on the boundary of the given rectangle.
 static R2Point SampleBoundary(const R2Rect& rect) {
   R2Point uv;
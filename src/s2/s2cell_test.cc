@@ -537,6 +537,39 @@ TEST(S2Cell, GetDistanceToPoint) {
   }
 }
 
+TEST(S2Cell, GetChildDistancesToPoint) {
+  // The batched child distances must be identical to the distances computed
+  // for each child separately.  Half of the target points are chosen near
+  // the cell so that all the cases in GetDistance() are exercised.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  for (int iter = 0; iter < 1000; ++iter) {
+    SCOPED_TRACE(StrCat("Iteration ", iter));
+    S2CellId id = S2Testing::GetRandomCellId();
+    if (id.is_leaf()) id = id.parent();
+    S2Cell cell(id);
+    S2Point target = S2Testing::RandomPoint();
+    if (iter % 2 == 0) {
+      S2Cap cap = cell.GetCapBound();
+      target = S2Testing::SamplePoint(S2Cap(cap.center(), 2 * cap.GetRadius()));
+    }
+    S2Cell children[4];
+    ASSERT_TRUE(cell.Subdivide(children));
+    S1ChordAngle distances[4], boundary_distances[4], max_distances[4];
+    ASSERT_TRUE(cell.GetChildDistances(target, distances));
+    ASSERT_TRUE(cell.GetChildBoundaryDistances(target, boundary_distances));
+    ASSERT_TRUE(cell.GetChildMaxDistances(target, max_distances));
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(children[i].GetDistance(target), distances[i]);
+      EXPECT_EQ(children[i].GetBoundaryDistance(target),
+                boundary_distances[i]);
+      EXPECT_EQ(children[i].GetMaxDistance(target), max_distances[i]);
+    }
+  }
+  S2Cell leaf(S2CellId(S2Testing::RandomPoint()));
+  S1ChordAngle distances[4];
+  EXPECT_FALSE(leaf.GetChildDistances(S2Testing::RandomPoint(), distances));
+}
+
 static void ChooseEdgeNearCell(const S2Cell& cell, S2Point* a, S2Point* b) {
   S2Cap cap = cell.GetCapBound();
   if (S2Testing::rnd.OneIn(5)) {
@@ -28,6 +28,7 @@
 #include "s2/s2cell_id.h"
 #include "s2/s2latlng_rect.h"
 #include "s2/s2metrics.h"
+#include "s2/s2parallel_internal.h"
 #include "s2/util/coding/coder.h"
 
 using std::is_sorted;
@@ -155,7 +156,9 @@ bool S2CellUnion::Normalize() {
   // Optimize the representation by discarding cells contained by other cells,
   // and looking for cases where all subcells of a parent cell are present.
 
-  std::sort(ids->begin(), ids->end());
+  if (!is_sorted(ids->begin(), ids->end())) {
+    std::sort(ids->begin(), ids->end());
+  }
   int out = 0;
   for (S2CellId id : *ids) {
     // Check whether this cell is contained by the previous cell.
@@ -401,24 +404,59 @@ S2CellUnion S2CellUnion::Difference(const S2CellUnion& y) const {
   return result;
 }
 
-void S2CellUnion::Expand(int expand_level) {
-  vector<S2CellId> output;
+// Appends the cells of "x" in the range [begin, end) expanded to
+// "expand_level", together with their neighbors at that level, to "output"
+// and sorts the result.
+static void ExpandRange(const S2CellUnion& x, int begin, int end,
+                        int expand_level, vector<S2CellId>* output) {
   uint64 level_lsb = S2CellId::lsb_for_level(expand_level);
-  for (int i = num_cells(); --i >= 0; ) {
-    S2CellId id = cell_id(i);
+  vector<S2CellId> neighbors;
+  for (int i = end; --i >= begin; ) {
+    S2CellId id = x.cell_id(i);
     if (id.lsb() < level_lsb) {
       id = id.parent(expand_level);
       // Optimization: skip over any cells contained by this one.  This is
       // especially important when very small regions are being expanded.
-      while (i > 0 && id.contains(cell_id(i - 1))) --i;
+      while (i > begin && id.contains(x.cell_id(i - 1))) --i;
+    }
+    output->push_back(id);
+    neighbors.clear();
+    id.AppendAllNeighbors(expand_level, &neighbors);
+    for (S2CellId neighbor : neighbors) {
+      // Most neighbors of cells in the interior of a large union are already
+      // covered by it, and discarding them here is much cheaper than sorting
+      // them and removing them during normalization.
+      if (!x.Contains(neighbor)) output->push_back(neighbor);
     }
-    output.push_back(id);
-    id.AppendAllNeighbors(expand_level, &output);
+  }
+  std::sort(output->begin(), output->end());
+}
+
+void S2CellUnion::Expand(int expand_level, int num_threads) {
+  const int n = num_cells();
+  // Each chunk is a contiguous range of cells.  Cells near the range
+  // boundaries may be expanded twice, which is harmless.
+  static const int kMinCellsPerChunk = 10000;
+  const int num_chunks = max(1, min(S2::internal::GetNumThreads(num_threads),
+                                    n / kMinCellsPerChunk));
+  vector<vector<S2CellId>> outputs(num_chunks);
+  S2::internal::ParallelForChunks(
+      n, num_chunks, num_threads, [&](int, int chunk, int begin, int end) {
+        ExpandRange(*this, begin, end, expand_level, &outputs[chunk]);
+      });
+
+  // Merge the sorted outputs so that Normalize() does not need to sort them.
+  vector<S2CellId> output = std::move(outputs[0]);
+  for (int i = 1; i < num_chunks; ++i) {
+    size_t mid = output.size();
+    output.insert(output.end(), outputs[i].begin(), outputs[i].end());
+    std::inplace_merge(output.begin(), output.begin() + mid, output.end());
   }
   Init(std::move(output));
 }
 
-void S2CellUnion::Expand(S1Angle min_radius, int max_level_diff) {
+void S2CellUnion::Expand(S1Angle min_radius, int max_level_diff,
+                         int num_threads) {
   int min_level = S2CellId::kMaxLevel;
   for (S2CellId id : *this) {
     min_level = min(min_level, id.level());
@@ -428,9 +466,9 @@ void S2CellUnion::Expand(S1Angle min_radius, int max_level_diff) {
   if (radius_level == 0 && min_radius.radians() > S2::kMinWidth.GetValue(0)) {
     // The requested expansion is greater than the width of a face cell.
     // The easiest way to handle this is to expand twice.
-    Expand(0);
+    Expand(0, num_threads);
   }
-  Expand(min(min_level + max_level_diff, radius_level));
+  Expand(min(min_level + max_level_diff, radius_level), num_threads);
 }
 
 uint64 S2CellUnion::LeafCellsCovered() const {
@@ -235,7 +235,11 @@ class S2CellUnion final : public S2Region {
   // there will be on the order of 4000 adjacent cells in the output.  For
   // most applications the Expand(min_radius, max_level_diff) method below is
   // easier to use.
-  void Expand(int expand_level);
+  //
+  // Very large unions can be expanded using several threads, where
+  // "num_threads" == 0 means one thread per hardware core.  The result does
+  // not depend on the number of threads.
+  void Expand(int expand_level, int num_threads = 1);
 
   // Expands the cell union such that it contains all points whose distance to
   // the cell union is at most "min_radius", but do not use cells that are
@@ -246,8 +250,8 @@ class S2CellUnion final : public S2Region {
   // region will always be expanded by approximately 1/16 the width of its
   // largest cell.  Note that in the worst case, the number of cells in the
   // output can be up to 4 * (1 + 2 ** max_level_diff) times larger than the
-  // number of cells in the input.
-  void Expand(S1Angle min_radius, int max_level_diff);
+  // number of cells in the input.  See above for "num_threads".
+  void Expand(S1Angle min_radius, int max_level_diff, int num_threads = 1);
 
   // The number of leaf cells covered by the union.
   // This will be no more than 6*2^60 for the whole sphere.
@@ -379,6 +379,43 @@ TEST(S2CellUnion, Expand) {
   }
 }
 
+// Expands "x" by adding all neighbors of every cell and normalizing the
+// result, which is the simplest correct implementation of Expand().
+static S2CellUnion GetSimpleExpansion(const S2CellUnion& x,
+                                      int expand_level) {
+  vector<S2CellId> output;
+  for (S2CellId id : x) {
+    if (id.level() > expand_level) id = id.parent(expand_level);
+    output.push_back(id);
+    id.AppendAllNeighbors(expand_level, &output);
+  }
+  return S2CellUnion(std::move(output));
+}
+
+TEST(S2CellUnion, ExpandMatchesSimpleExpansion) {
+  // Build unions large enough to be expanded using several threads, made of
+  // random cells at several levels so that some are smaller and some are
+  // larger than the expansion level.
+  for (int iter = 0; iter < 2; ++iter) {
+    S2Cap cap(S2Testing::RandomPoint(), S1Angle::Degrees(1));
+    vector<S2CellId> ids;
+    for (int i = 0; i < 50000; ++i) {
+      ids.push_back(S2CellId(S2Testing::SamplePoint(cap))
+                    .parent(14 + rnd.Uniform(6)));
+    }
+    S2CellUnion x(std::move(ids));
+    for (int expand_level : {10, 16}) {
+      SCOPED_TRACE(StrCat("expand_level=", expand_level));
+      S2CellUnion expected = GetSimpleExpansion(x, expand_level);
+      for (int num_threads : {1, 3}) {
+        S2CellUnion actual = x;
+        actual.Expand(expand_level, num_threads);
+        EXPECT_EQ(expected, actual);
+      }
+    }
+  }
+}
+
 TEST(S2CellUnion, EncodeDecode) {
   vector<S2CellId> cell_ids = {S2CellId(0x33),
                                S2CellId(0x8e3748fab),
@@ -17,7 +17,9 @@
 
 #include "s2/s2closest_cell_query.h"
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 #include "s2/third_party/absl/memory/memory.h"
 #include "s2/s1angle.h"
 #include "s2/s2cap.h"
@@ -25,9 +27,13 @@
 #include "s2/s2cell_id.h"
 #include "s2/s2cell_union.h"
 #include "s2/s2edge_distances.h"
+#include "s2/s2parallel_internal.h"
 #include "s2/s2region_coverer.h"
 #include "s2/s2shape_index_region.h"
 
+using std::pair;
+using std::vector;
+
 void S2ClosestCellQuery::Options::set_conservative_max_distance(
     S1ChordAngle max_distance) {
   set_max_distance(Distance(max_distance.PlusError(
@@ -94,7 +100,7 @@ S2ClosestCellQuery::~S2ClosestCellQuery() {
 }
 
 bool S2ClosestCellQuery::IsDistanceLess(Target* target, S1ChordAngle limit) {
-  static_assert(sizeof(Options) <= 32, "Consider not copying Options here");
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
   Options tmp_options = options_;
   tmp_options.set_max_results(1);
   tmp_options.set_max_distance(limit);
@@ -104,7 +110,7 @@ bool S2ClosestCellQuery::IsDistanceLess(Target* target, S1ChordAngle limit) {
 
 bool S2ClosestCellQuery::IsDistanceLessOrEqual(Target* target,
                                                S1ChordAngle limit) {
-  static_assert(sizeof(Options) <= 32, "Consider not copying Options here");
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
   Options tmp_options = options_;
   tmp_options.set_max_results(1);
   tmp_options.set_inclusive_max_distance(limit);
@@ -114,10 +120,52 @@ bool S2ClosestCellQuery::IsDistanceLessOrEqual(Target* target,
 
 bool S2ClosestCellQuery::IsConservativeDistanceLessOrEqual(
     Target* target, S1ChordAngle limit) {
-  static_assert(sizeof(Options) <= 32, "Consider not copying Options here");
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
   Options tmp_options = options_;
   tmp_options.set_max_results(1);
   tmp_options.set_conservative_max_distance(limit);
   tmp_options.set_max_error(S1ChordAngle::Straight());
   return !base_.FindClosestCell(target, tmp_options).is_empty();
 }
+
+void S2ClosestCellQuery::FindClosestCellForEachPoint(
+    absl::Span<const S2Point> points, vector<Result>* results,
+    int num_threads) {
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
+  Options tmp_options = options_;
+  tmp_options.set_max_results(1);
+  const int n = points.size();
+  results->assign(n, Result());
+
+  // Sort the points so that consecutive points are usually close together.
+  vector<pair<S2CellId, int>> order(n);
+  for (int i = 0; i < n; ++i) order[i] = {S2CellId(points[i]), i};
+  std::sort(order.begin(), order.end());
+
+  // Each chunk is a contiguous run of points, processed using the result for
+  // the previous point as a hint.  The runs are long enough to amortize the
+  // cost of starting a thread and initializing its query.  Each thread other
+  // than the calling thread needs its own query.
+  const int kMinPointsPerChunk = 1000;
+  num_threads = S2::internal::GetNumThreads(num_threads);
+  const int num_chunks = std::max(1, std::min(num_threads,
+                                              n / kMinPointsPerChunk));
+  vector<std::unique_ptr<Base>> bases(num_threads);
+  S2::internal::ParallelForChunks(
+      n, num_chunks, num_threads, [&](int thread, int, int begin, int end) {
+        Base* base = &base_;
+        if (thread > 0) {
+          if (bases[thread] == nullptr) {
+            bases[thread] = absl::make_unique<Base>(&index());
+          }
+          base = bases[thread].get();
+        }
+        Result hint;
+        for (int i = begin; i < end; ++i) {
+          int j = order[i].second;
+          PointTarget target(points[j]);
+          (*results)[j] = base->FindClosestCell(&target, tmp_options, hint);
+          if (!(*results)[j].is_empty()) hint = (*results)[j];
+        }
+      });
+}
@@ -28,6 +28,7 @@
 #include "s2/s2cell_id.h"
 #include "s2/s2closest_cell_query_base.h"
 #include "s2/s2min_distance_targets.h"
+#include "s2/third_party/absl/types/span.h"
 
 // S2ClosestCellQuery is a helper class for finding the closest cell(s) to a
 // given point, edge, S2Cell, S2CellUnion, or geometry collection.  A typical
@@ -151,6 +152,7 @@ class S2ClosestCellQuery {
 
     // Inherited options (see s2closest_cell_query_base.h for details):
     using Base::Options::set_max_results;
+    using Base::Options::set_max_relative_error;
     using Base::Options::set_region;
     using Base::Options::set_use_brute_force;
   };
@@ -250,6 +252,20 @@ class S2ClosestCellQuery {
   // is_empty() == true.
   Result FindClosestCell(Target* target);
 
+  // Finds the closest cell to each of the given points, as though
+  // FindClosestCell() were called with a PointTarget for each one, and
+  // returns the results in the same order as "points".
+  //
+  // This is much faster than separate queries for large batches of nearby
+  // points (e.g., looking up the service area containing each of many
+  // locations).  The points are processed in S2CellId order, and the result
+  // for each point is used to bound the search radius for the next one.  The
+  // sorted points are divided into contiguous runs among "num_threads"
+  // threads (0 means use one thread per hardware core).
+  void FindClosestCellForEachPoint(absl::Span<const S2Point> points,
+                                   std::vector<Result>* results,
+                                   int num_threads = 1);
+
   // Returns the minimum distance to the target.  If the index or target is
   // empty, returns S1ChordAngle::Infinity().
   //
@@ -372,7 +388,7 @@ inline void S2ClosestCellQuery::FindClosestCells(Target* target,
 
 inline S2ClosestCellQuery::Result S2ClosestCellQuery::FindClosestCell(
     Target* target) {
-  static_assert(sizeof(Options) <= 32, "Consider not copying Options here");
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
   Options tmp_options = options_;
   tmp_options.set_max_results(1);
   return base_.FindClosestCell(target, tmp_options);
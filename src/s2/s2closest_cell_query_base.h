@@ -20,11 +20,13 @@
 #ifndef S2_S2CLOSEST_CELL_QUERY_BASE_H_
 #define S2_S2CLOSEST_CELL_QUERY_BASE_H_
 
+#include <algorithm>
 #include <vector>
 
 #include "s2/base/logging.h"
 #include "s2/util/gtl/btree_set.h"
 #include "s2/third_party/absl/container/inlined_vector.h"
+#include "s2/s1angle.h"
 #include "s2/s1chord_angle.h"
 #include "s2/s2cap.h"
 #include "s2/s2cell_id.h"
@@ -118,6 +120,14 @@ class S2ClosestCellQueryBase {
     Delta max_error() const;
     void set_max_error(Delta max_error);
 
+    // Like max_error(), except that the allowable error is a fraction of the
+    // distance to the result being replaced (see S2ClosestEdgeQueryBase).
+    //
+    // REQUIRES: max_relative_error >= 0
+    // DEFAULT: 0
+    double max_relative_error() const;
+    void set_max_relative_error(double max_relative_error);
+
     // Specifies that cells must intersect the given S2Region.  "region" is
     // owned by the caller and must persist during the lifetime of this
     // object.  The value may be changed between calls to FindClosestPoints(),
@@ -141,6 +151,7 @@ class S2ClosestCellQueryBase {
    private:
     Distance max_distance_ = Distance::Infinity();
     Delta max_error_ = Delta::Zero();
+    double max_relative_error_ = 0;
     const S2Region* region_ = nullptr;
     int max_results_ = kMaxMaxResults;
     bool use_brute_force_ = false;
@@ -252,20 +263,41 @@ class S2ClosestCellQueryBase {
   Result FindClosestCell(Target* target, const Options& options);
 
  private:
+  // S2ClosestCellQuery::FindClosestCells() uses the hinted FindClosestCell()
+  // below for its batch version.
+  friend class S2ClosestCellQuery;
+
   using CellIterator = S2CellIndex::CellIterator;
   using ContentsIterator = S2CellIndex::ContentsIterator;
   using NonEmptyRangeIterator = S2CellIndex::NonEmptyRangeIterator;
   using RangeIterator = S2CellIndex::RangeIterator;
 
   const Options& options() const { return *options_; }
-  void FindClosestCellsInternal(Target* target, const Options& options);
+
+  // Like FindClosestCell(), except that the cell in "hint" (typically the
+  // result for a nearby target) is tested first.  This does not change the
+  // distance of the result, but it can greatly reduce the search radius when
+  // the hint is close to optimal.  "hint" may be empty.
+  //
+  // REQUIRES: options.max_results() == 1
+  // REQUIRES: "hint" is empty or was returned by a query on this index.
+  Result FindClosestCell(Target* target, const Options& options,
+                         const Result& hint);
+
+  void FindClosestCellsInternal(Target* target, const Options& options,
+                                const Result* hint = nullptr);
   void FindClosestCellsBruteForce();
   void FindClosestCellsOptimized();
   void InitQueue();
   void InitCovering();
   void AddInitialRange(S2CellId first_id, S2CellId last_id);
   void MaybeAddResult(S2CellId cell_id, Label label);
+  Distance GetDistanceLimit(Distance distance) const;
   bool ProcessOrEnqueue(S2CellId id, NonEmptyRangeIterator* iter, bool seek);
+  bool MaybeProcessRanges(S2CellId id, NonEmptyRangeIterator* iter,
+                          bool seek);
+  void EnqueueChildren(S2CellId id, const bool pending[4], int num_pending);
+  void Enqueue(S2CellId id, Distance distance);
   void AddRange(const RangeIterator& range);
 
   const S2CellIndex* index_;
@@ -415,6 +447,19 @@ inline void S2ClosestCellQueryBase<Distance>::Options::set_max_error(
   max_error_ = max_error;
 }
 
+template <class Distance>
+inline double
+S2ClosestCellQueryBase<Distance>::Options::max_relative_error() const {
+  return max_relative_error_;
+}
+
+template <class Distance>
+inline void S2ClosestCellQueryBase<Distance>::Options::set_max_relative_error(
+    double max_relative_error) {
+  S2_DCHECK_GE(max_relative_error, 0);
+  max_relative_error_ = max_relative_error;
+}
+
 template <class Distance>
 inline const S2Region* S2ClosestCellQueryBase<Distance>::Options::region()
     const {
@@ -492,6 +537,15 @@ S2ClosestCellQueryBase<Distance>::FindClosestCell(
   return result_singleton_;
 }
 
+template <class Distance>
+typename S2ClosestCellQueryBase<Distance>::Result
+S2ClosestCellQueryBase<Distance>::FindClosestCell(
+    Target* target, const Options& options, const Result& hint) {
+  S2_DCHECK_EQ(options.max_results(), 1);
+  FindClosestCellsInternal(target, options, &hint);
+  return result_singleton_;
+}
+
 template <class Distance>
 void S2ClosestCellQueryBase<Distance>::FindClosestCells(
     Target* target, const Options& options, std::vector<Result>* results) {
@@ -514,7 +568,7 @@ void S2ClosestCellQueryBase<Distance>::FindClosestCells(
 
 template <class Distance>
 void S2ClosestCellQueryBase<Distance>::FindClosestCellsInternal(
-    Target* target, const Options& options) {
+    Target* target, const Options& options, const Result* hint) {
   target_ = target;
   options_ = &options;
 
@@ -565,14 +619,23 @@ void S2ClosestCellQueryBase<Distance>::FindClosestCellsInternal(
        Distance::Zero() < distance_limit_ - options.max_error());
 
   // Use the brute force algorithm if the index is small enough.
-  if (options.use_brute_force() ||
-      index_->num_cells() <= target_->max_brute_force_index_size()) {
-    avoid_duplicates_ = false;
+  bool use_brute_force = options.use_brute_force() ||
+      index_->num_cells() <= target_->max_brute_force_index_size();
+
+  // If the target takes advantage of max_error() then we need to avoid
+  // duplicate edges explicitly.  (Otherwise it happens automatically.)
+  avoid_duplicates_ = (!use_brute_force && target_uses_max_error &&
+                       options.max_results() > 1);
+
+  // Testing the hint first reduces distance_limit_, and therefore the search
+  // radius.  The hint cannot be reported twice since max_results() == 1.
+  if (hint != nullptr && !hint->is_empty()) {
+    MaybeAddResult(hint->cell_id(), hint->label());
+    if (distance_limit_ == Distance::Zero()) return;
+  }
+  if (use_brute_force) {
     FindClosestCellsBruteForce();
   } else {
-    // If the target takes advantage of max_error() then we need to avoid
-    // duplicate edges explicitly.  (Otherwise it happens automatically.)
-    avoid_duplicates_ = (target_uses_max_error && options.max_results() > 1);
     FindClosestCellsOptimized();
   }
 }
@@ -602,12 +665,18 @@ void S2ClosestCellQueryBase<Distance>::FindClosestCellsOptimized() {
     S2CellId child = entry.id.child_begin();
     // We already know that it has too many cells, so process its children.
     // Each child may either be processed directly or enqueued again.  The
-    // loop is optimized so that we don't seek unnecessarily.
+    // loop is optimized so that we don't seek unnecessarily.  The distances
+    // to the children that are enqueued are computed together.
     bool seek = true;
+    bool pending[4];
+    int num_pending = 0;
     NonEmptyRangeIterator range(index_);
     for (int i = 0; i < 4; ++i, child = child.next()) {
-      seek = ProcessOrEnqueue(child, &range, seek);
+      pending[i] = !MaybeProcessRanges(child, &range, seek);
+      if (pending[i]) ++num_pending;
+      seek = pending[i];
     }
+    EnqueueChildren(entry.id, pending, num_pending);
   }
 }
 
@@ -744,6 +813,15 @@ void S2ClosestCellQueryBase<Distance>::AddInitialRange(
   index_covering_.push_back(first_id.parent(level));
 }
 
+// Returns the distance limit to use once the worst result to be returned is
+// at the given distance (see S2::GetDistanceLimit).
+template <class Distance>
+inline Distance S2ClosestCellQueryBase<Distance>::GetDistanceLimit(
+    Distance distance) const {
+  return S2::GetDistanceLimit(distance, options().max_error(),
+                              options().max_relative_error());
+}
+
 // TODO(ericv): Consider having this method return false when distance_limit_
 // is reduced to zero, and terminating any calling loops early.
 template <class Distance>
@@ -769,7 +847,7 @@ void S2ClosestCellQueryBase<Distance>::MaybeAddResult(S2CellId cell_id,
   if (options().max_results() == 1) {
     // Optimization for the common case where only the closest cell is wanted.
     result_singleton_ = result;
-    distance_limit_ = result.distance() - options().max_error();
+    distance_limit_ = GetDistanceLimit(result.distance());
   } else if (options().max_results() == Options::kMaxMaxResults) {
     result_vector_.push_back(result);  // Sort/unique at end.
   } else {
@@ -782,8 +860,7 @@ void S2ClosestCellQueryBase<Distance>::MaybeAddResult(S2CellId cell_id,
       if (size > options().max_results()) {
         result_set_.erase(--result_set_.end());
       }
-      distance_limit_ = (--result_set_.end())->distance() -
-                        options().max_error();
+      distance_limit_ = GetDistanceLimit((--result_set_.end())->distance());
     }
   }
 }
@@ -798,36 +875,88 @@ void S2ClosestCellQueryBase<Distance>::MaybeAddResult(S2CellId cell_id,
 template <class Distance>
 bool S2ClosestCellQueryBase<Distance>::ProcessOrEnqueue(
     S2CellId id, NonEmptyRangeIterator* iter, bool seek) {
+  if (MaybeProcessRanges(id, iter, seek)) return false;
+
+  // Otherwise compute the minimum distance to any point in the cell and add
+  // it to the priority queue.
+  Distance distance = distance_limit_;
+  if (target_->UpdateMinDistance(S2Cell(id), &distance)) {
+    Enqueue(id, distance);
+  }
+  return true;  // Seek to next child.
+}
+
+// Processes the contents of the given cell immediately if it intersects only
+// a few leaf cell ranges, in which case "iter" is positioned at the first
+// non-empty range (if any) with start_id() > id.range_max(), and returns
+// true.  Otherwise returns false, indicating that the cell should be
+// enqueued.  "seek" is as for ProcessOrEnqueue().
+template <class Distance>
+bool S2ClosestCellQueryBase<Distance>::MaybeProcessRanges(
+    S2CellId id, NonEmptyRangeIterator* iter, bool seek) {
   if (seek) iter->Seek(id.range_min());
   S2CellId last = id.range_max();
-  if (iter->start_id() > last) {
-    return false;  // No need to seek to next child.
-  }
+  if (iter->start_id() > last) return true;
+
   // If this cell intersects at least "kMinRangesToEnqueue" leaf cell ranges
   // (including ranges whose contents are empty), then enqueue it.  We test
   // this by advancing (n - 1) ranges and checking whether that range also
   // intersects this cell.
   RangeIterator max_it = *iter;
   if (max_it.Advance(kMinRangesToEnqueue - 1) && max_it.start_id() <= last) {
-    // This cell intersects at least kMinRangesToEnqueue ranges, so enqueue it.
-    S2Cell cell(id);
-    Distance distance = distance_limit_;
-    // We check "region_" second because it may be relatively expensive.
-    if (target_->UpdateMinDistance(cell, &distance) &&
-        (!options().region() || options().region()->MayIntersect(cell))) {
-      if (use_conservative_cell_distance_) {
-        // Ensure that "distance" is a lower bound on distance to the cell.
-        distance = distance - options().max_error();
-      }
-      queue_.push(QueueEntry(distance, id));
-    }
-    return true;  // Seek to next child.
+    return false;
   }
   // There were few enough ranges that we might as well process them now.
   for (; iter->start_id() <= last; iter->Next()) {
     AddRange(*iter);
   }
-  return false;  // No need to seek to next child.
+  return true;
+}
+
+// Enqueues the children of "id" for which pending[k] is true.  When several
+// children are pending it is cheaper to compute their distances together,
+// since the children share vertices and edges.
+template <class Distance>
+void S2ClosestCellQueryBase<Distance>::EnqueueChildren(
+    S2CellId id, const bool pending[4], int num_pending) {
+  if (num_pending == 0) return;
+  // No distance can be less than Zero(), so the target may skip children
+  // whose distance is initialized to that value.
+  Distance distances[4];
+  for (int k = 0; k < 4; ++k) {
+    distances[k] = pending[k] ? distance_limit_ : Distance::Zero();
+  }
+  if (num_pending == 1) {
+    for (int k = 0; k < 4; ++k) {
+      if (pending[k]) {
+        target_->UpdateMinDistance(S2Cell(id.child(k)), &distances[k]);
+      }
+    }
+  } else {
+    target_->UpdateChildMinDistances(S2Cell(id), distances);
+  }
+  for (int k = 0; k < 4; ++k) {
+    if (pending[k] && distances[k] < distance_limit_) {
+      Enqueue(id.child(k), distances[k]);
+    }
+  }
+}
+
+// Adds the given cell to the priority queue, where "distance" is the minimum
+// distance from the target to any point in the cell.
+template <class Distance>
+inline void S2ClosestCellQueryBase<Distance>::Enqueue(S2CellId id,
+                                                      Distance distance) {
+  // We check "region_" after computing the distance because it may be
+  // relatively expensive.
+  if (options().region() && !options().region()->MayIntersect(S2Cell(id))) {
+    return;
+  }
+  if (use_conservative_cell_distance_) {
+    // Ensure that "distance" is a lower bound on distance to the cell.
+    distance = distance - options().max_error();
+  }
+  queue_.push(QueueEntry(distance, id));
 }
 
 template <class Distance>
@@ -382,6 +382,66 @@ static void TestWithIndexFactory(const CellIndexFactory& factory,
   }
 }
 
+TEST(S2ClosestCellQuery, MaxRelativeError) {
+  // Checks that each result is within a factor of (1 + max_relative_error())
+  // of the corresponding exact result.
+  const double kMaxRelativeError = 0.1;
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Cap index_cap(S2Testing::RandomPoint(), kTestCapRadius);
+  S2CellIndex index;
+  PointCloudCellIndexFactory().AddCells(index_cap, 1000, &index);
+  index.Build();
+  S2ClosestCellQuery::Options options;
+  options.set_max_results(5);
+  S2ClosestCellQuery exact_query(&index, options);
+  options.set_max_relative_error(kMaxRelativeError);
+  S2ClosestCellQuery query(&index, options);
+  S2Cap query_cap(index_cap.center(), 4 * kTestCapRadius);
+  for (int i = 0; i < 100; ++i) {
+    S2ClosestCellQuery::PointTarget target(S2Testing::SamplePoint(query_cap));
+    auto expected = exact_query.FindClosestCells(&target);
+    auto actual = query.FindClosestCells(&target);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (int j = 0; j < actual.size(); ++j) {
+      EXPECT_LE(actual[j].distance().ToAngle().radians(),
+                (1 + kMaxRelativeError) *
+                expected[j].distance().ToAngle().radians() + 1e-15);
+    }
+  }
+}
+
+TEST(S2ClosestCellQuery, FindClosestCellForEachPoint) {
+  // Checks that the batch results match those of individual queries, with
+  // and without a distance limit.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Cap index_cap(S2Testing::RandomPoint(), kTestCapRadius);
+  S2CellIndex index;
+  CapsCellIndexFactory(16 /*max_cells_per_cap*/, 0.1 /*density*/).AddCells(
+      index_cap, 100, &index);
+  index.Build();
+  S2Cap query_cap(index_cap.center(), 2 * kTestCapRadius);
+  vector<S2Point> points;
+  for (int i = 0; i < 3000; ++i) {
+    points.push_back(S2Testing::SamplePoint(query_cap));
+  }
+  S2ClosestCellQuery query(&index);
+  query.mutable_options()->set_max_results(5);  // Should be ignored.
+  for (S1Angle max_distance : {S1Angle::Infinity(), 0.1 * kTestCapRadius}) {
+    query.mutable_options()->set_max_distance(max_distance);
+    for (int num_threads : {1, 3}) {
+      vector<S2ClosestCellQuery::Result> results;
+      query.FindClosestCellForEachPoint(points, &results, num_threads);
+      ASSERT_EQ(points.size(), results.size());
+      for (int i = 0; i < points.size(); ++i) {
+        S2ClosestCellQuery::PointTarget target(points[i]);
+        auto expected = query.FindClosestCell(&target);
+        EXPECT_EQ(expected.is_empty(), results[i].is_empty());
+        EXPECT_EQ(expected.distance(), results[i].distance());
+      }
+    }
+  }
+}
+
 static const int kNumIndexes = 20;
 static const int kNumCells = 100;
 static const int kNumQueries = 100;
@@ -163,6 +163,7 @@ class S2ClosestEdgeQuery {
 
     // Inherited options (see s2closest_edge_query_base.h for details):
     using Base::Options::set_max_results;
+    using Base::Options::set_max_relative_error;
     using Base::Options::set_include_interiors;
     using Base::Options::set_use_brute_force;
   };
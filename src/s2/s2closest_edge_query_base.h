@@ -18,6 +18,7 @@
 #ifndef S2_S2CLOSEST_EDGE_QUERY_BASE_H_
 #define S2_S2CLOSEST_EDGE_QUERY_BASE_H_
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -120,6 +121,23 @@ class S2ClosestEdgeQueryBase {
     Delta max_error() const;
     void set_max_error(Delta max_error);
 
+    // Like max_error(), except that the allowable error is a fraction of the
+    // distance to the result being replaced.  For example, a value of 0.01
+    // means that the distance to each result may be up to 1% larger than the
+    // distance to the corresponding true result.  (When Distance measures
+    // maximum distances, e.g. S2FurthestEdgeQuery, the distance to each true
+    // result may instead be up to 1% larger than the distance to the
+    // corresponding result.)  Cells are then pruned as soon as they cannot
+    // improve the current results by more than this fraction, which can be
+    // much faster when the results are far away compared to the desired
+    // absolute accuracy.  If both options are specified, the larger of the
+    // two errors is allowed.  See S2::GetDistanceLimit() for details.
+    //
+    // REQUIRES: max_relative_error >= 0
+    // DEFAULT: 0
+    double max_relative_error() const;
+    void set_max_relative_error(double max_relative_error);
+
     // Specifies that polygon interiors should be included when measuring
     // distances.  In other words, polygons that contain the target should
     // have a distance of zero.  (For targets consisting of multiple connected
@@ -146,6 +164,7 @@ class S2ClosestEdgeQueryBase {
    private:
     Distance max_distance_ = Distance::Infinity();
     Delta max_error_ = Delta::Zero();
+    double max_relative_error_ = 0;
     int max_results_ = kMaxMaxResults;
     bool include_interiors_ = true;
     bool use_brute_force_ = false;
@@ -283,10 +302,15 @@ class S2ClosestEdgeQueryBase {
   void AddInitialRange(const S2ShapeIndex::Iterator& first,
                        const S2ShapeIndex::Iterator& last);
   void MaybeAddResult(const S2Shape& shape, int edge_id);
+  Distance GetDistanceLimit(Distance distance) const;
   void AddResult(const Result& result);
   void ProcessEdges(const QueueEntry& entry);
-  void ProcessOrEnqueue(S2CellId id);
   void ProcessOrEnqueue(S2CellId id, const S2ShapeIndexCell* index_cell);
+  bool MaybeProcessEdges(S2CellId id, const S2ShapeIndexCell* index_cell);
+  void EnqueueChildren(S2CellId id, const S2ShapeIndexCell* child_cells[4],
+                       const bool pending[4], int num_pending);
+  void Enqueue(S2CellId id, const S2ShapeIndexCell* index_cell,
+               Distance distance);
 
   const S2ShapeIndex* index_;
   const Options* options_;
@@ -317,6 +341,12 @@ class S2ClosestEdgeQueryBase {
   int index_num_edges_;
   int index_num_edges_limit_;
 
+  // Whether the index contains any polygons (i.e., shapes of dimension 2),
+  // or -1 if this has not been determined yet.  When there are no polygons,
+  // the target's VisitContainingShapes() method (which typically needs to
+  // allocate an index iterator) does not need to be called.
+  int index_has_polygons_;
+
   // The distance beyond which we can safely ignore further candidate edges.
   // (Candidates that are exactly at the limit are ignored; this is more
   // efficient for UpdateMinDistance() and should not affect clients since
@@ -333,6 +363,11 @@ class S2ClosestEdgeQueryBase {
   //  - If max_results() == "infinity", results are appended to result_vector_
   //    and sorted/uniqued at the end.
   //
+  //  - If max_results() <= kMaxSortedResults, results are kept in
+  //    result_array_, a sorted vector whose storage is reused across calls.
+  //    Linear-time insertion is faster than a btree_set for such small
+  //    result sets, and it means that queries do not allocate memory.
+  //
   //  - Otherwise results are kept in a btree_set so that we can progressively
   //    reduce the distance limit once max_results() results have been found.
   //    (A priority queue is not sufficient because we need to be able to
@@ -340,8 +375,10 @@ class S2ClosestEdgeQueryBase {
   //
   // TODO(ericv): Check whether it would be faster to use avoid_duplicates_
   // when result_set_ is used so that we could use a priority queue instead.
+  static constexpr int kMaxSortedResults = 16;
   Result result_singleton_;
   std::vector<Result> result_vector_;
+  std::vector<Result> result_array_;
   gtl::btree_set<Result> result_set_;
 
   // When the result edges are stored in a btree_set (see above), usually
@@ -391,13 +428,19 @@ class S2ClosestEdgeQueryBase {
       return other.distance < distance;
     }
   };
-  using CellQueue =
-      std::priority_queue<QueueEntry, absl::InlinedVector<QueueEntry, 16>>;
+  // A priority queue that retains its storage when it is cleared, so that
+  // repeated queries do not need to reallocate it.
+  class CellQueue : public std::priority_queue<
+      QueueEntry, absl::InlinedVector<QueueEntry, 16>> {
+   public:
+    void clear() { this->c.erase(this->c.begin(), this->c.end()); }
+  };
   CellQueue queue_;
 
   // Temporaries, defined here to avoid multiple allocations / initializations.
 
   S2ShapeIndex::Iterator iter_;
+  std::vector<int32> containing_shape_ids_;
   std::vector<S2CellId> max_distance_covering_;
   std::vector<S2CellId> initial_cells_;
 };
@@ -446,6 +489,19 @@ inline void S2ClosestEdgeQueryBase<Distance>::Options::set_max_error(
   max_error_ = max_error;
 }
 
+template <class Distance>
+inline double
+S2ClosestEdgeQueryBase<Distance>::Options::max_relative_error() const {
+  return max_relative_error_;
+}
+
+template <class Distance>
+inline void S2ClosestEdgeQueryBase<Distance>::Options::set_max_relative_error(
+    double max_relative_error) {
+  S2_DCHECK_GE(max_relative_error, 0);
+  max_relative_error_ = max_relative_error;
+}
+
 template <class Distance>
 inline bool S2ClosestEdgeQueryBase<Distance>::Options::include_interiors()
     const {
@@ -496,6 +552,7 @@ template <class Distance>
 void S2ClosestEdgeQueryBase<Distance>::ReInit() {
   index_num_edges_ = 0;
   index_num_edges_limit_ = 0;
+  index_has_polygons_ = -1;
   index_covering_.clear();
   index_cells_.clear();
   // We don't initialize iter_ here to make queries on small indexes a bit
@@ -540,6 +597,9 @@ void S2ClosestEdgeQueryBase<Distance>::FindClosestEdges(
     std::unique_copy(result_vector_.begin(), result_vector_.end(),
                      std::back_inserter(*results));
     result_vector_.clear();
+  } else if (options.max_results() <= kMaxSortedResults) {
+    results->assign(result_array_.begin(), result_array_.end());
+    result_array_.clear();
   } else {
     results->assign(result_set_.begin(), result_set_.end());
     result_set_.clear();
@@ -556,6 +616,7 @@ void S2ClosestEdgeQueryBase<Distance>::FindClosestEdgesInternal(
   distance_limit_ = options.max_distance();
   result_singleton_ = Result();
   S2_DCHECK(result_vector_.empty());
+  S2_DCHECK(result_array_.empty());
   S2_DCHECK(result_set_.empty());
   S2_DCHECK_GE(target->max_brute_force_index_size(), 0);
   if (distance_limit_ == Distance::Zero()) return;
@@ -566,17 +627,45 @@ void S2ClosestEdgeQueryBase<Distance>::FindClosestEdgesInternal(
   }
 
   if (options.include_interiors()) {
-    gtl::btree_set<int32> shape_ids;
-    (void) target->VisitContainingShapes(
-        *index_, [&shape_ids, &options](S2Shape* containing_shape,
-                                        const S2Point& target_point) {
-          shape_ids.insert(containing_shape->id());
-          return shape_ids.size() < options.max_results();
-        });
-    for (int shape_id : shape_ids) {
-      AddResult(Result(Distance::Zero(), shape_id, -1));
+    if (index_has_polygons_ < 0) {
+      index_has_polygons_ = 0;
+      for (S2Shape* shape : *index_) {
+        if (shape != nullptr && shape->dimension() == 2) {
+          index_has_polygons_ = 1;
+          break;
+        }
+      }
+    }
+    if (index_has_polygons_) {
+      // The result must be sorted by shape id.  A shape may be visited once
+      // for each target point it contains, so the ids are deduplicated by
+      // sorting whenever the vector reaches "next_dedup" entries.  Doubling
+      // this threshold keeps the total cost O(k log k) for k visits.
+      std::vector<int32>* shape_ids = &containing_shape_ids_;
+      shape_ids->clear();
+      const size_t max_results = options.max_results();
+      size_t next_dedup = max_results;
+      auto dedup = [shape_ids]() {
+        std::sort(shape_ids->begin(), shape_ids->end());
+        shape_ids->erase(std::unique(shape_ids->begin(), shape_ids->end()),
+                         shape_ids->end());
+      };
+      (void) target->VisitContainingShapes(
+          *index_, [shape_ids, max_results, &next_dedup, &dedup](
+                       S2Shape* containing_shape, const S2Point& target_point) {
+            shape_ids->push_back(containing_shape->id());
+            if (shape_ids->size() < next_dedup) return true;
+            dedup();
+            next_dedup = std::max(max_results, 2 * shape_ids->size());
+            return shape_ids->size() < max_results;
+          });
+      dedup();
+      if (shape_ids->size() > max_results) shape_ids->resize(max_results);
+      for (int shape_id : *shape_ids) {
+        AddResult(Result(Distance::Zero(), shape_id, -1));
+      }
+      if (distance_limit_ == Distance::Zero()) return;
     }
-    if (distance_limit_ == Distance::Zero()) return;
   }
 
   // If max_error() > 0 and the target takes advantage of this, then we may
@@ -658,7 +747,7 @@ void S2ClosestEdgeQueryBase<Distance>::FindClosestEdgesOptimized() {
     // entry.distance.
     Distance distance = entry.distance;
     if (!(distance < distance_limit_)) {
-      queue_ = CellQueue();  // Clear any remaining entries.
+      queue_.clear();  // Clear any remaining entries.
       break;
     }
     // If this is already known to be an index cell, just process it.
@@ -670,21 +759,36 @@ void S2ClosestEdgeQueryBase<Distance>::FindClosestEdgesOptimized() {
     // child back to the queue, we first check whether it is empty.  We do
     // this in two seek operations rather than four by seeking to the key
     // between children 0 and 1 and to the key between children 2 and 3.
+    // Children that are small index cells are processed immediately, and
+    // the distances to the remaining children are computed together.
     S2CellId id = entry.id;
+    const S2ShapeIndexCell* child_cells[4];
+    bool pending[4] = {false, false, false, false};
+    int num_pending = 0;
+    auto visit_child = [&](int k) {
+      S2CellId child = id.child(k);
+      S2_DCHECK(child.contains(iter_.id()));
+      child_cells[k] = (iter_.id() == child) ? &iter_.cell() : nullptr;
+      if (!MaybeProcessEdges(child, child_cells[k])) {
+        pending[k] = true;
+        ++num_pending;
+      }
+    };
     iter_.Seek(id.child(1).range_min());
     if (!iter_.done() && iter_.id() <= id.child(1).range_max()) {
-      ProcessOrEnqueue(id.child(1));
+      visit_child(1);
     }
     if (iter_.Prev() && iter_.id() >= id.range_min()) {
-      ProcessOrEnqueue(id.child(0));
+      visit_child(0);
     }
     iter_.Seek(id.child(3).range_min());
     if (!iter_.done() && iter_.id() <= id.range_max()) {
-      ProcessOrEnqueue(id.child(3));
+      visit_child(3);
     }
     if (iter_.Prev() && iter_.id() >= id.child(2).range_min()) {
-      ProcessOrEnqueue(id.child(2));
+      visit_child(2);
     }
+    EnqueueChildren(id, child_cells, pending, num_pending);
   }
 }
 
@@ -838,6 +942,15 @@ void S2ClosestEdgeQueryBase<Distance>::AddInitialRange(
   }
 }
 
+// Returns the distance limit to use once the worst result to be returned is
+// at the given distance (see S2::GetDistanceLimit).
+template <class Distance>
+inline Distance S2ClosestEdgeQueryBase<Distance>::GetDistanceLimit(
+    Distance distance) const {
+  return S2::GetDistanceLimit(distance, options().max_error(),
+                              options().max_relative_error());
+}
+
 template <class Distance>
 void S2ClosestEdgeQueryBase<Distance>::MaybeAddResult(
     const S2Shape& shape, int edge_id) {
@@ -857,9 +970,21 @@ void S2ClosestEdgeQueryBase<Distance>::AddResult(const Result& result) {
   if (options().max_results() == 1) {
     // Optimization for the common case where only the closest edge is wanted.
     result_singleton_ = result;
-    distance_limit_ = result.distance() - options().max_error();
+    distance_limit_ = GetDistanceLimit(result.distance());
   } else if (options().max_results() == Options::kMaxMaxResults) {
     result_vector_.push_back(result);  // Sort/unique at end.
+  } else if (options().max_results() <= kMaxSortedResults) {
+    // Like the btree_set case below, except that the results are kept in a
+    // small sorted vector.  Duplicate results are not inserted.
+    auto it = std::lower_bound(result_array_.begin(), result_array_.end(),
+                               result);
+    if (it != result_array_.end() && *it == result) return;
+    result_array_.insert(it, result);
+    int size = result_array_.size();
+    if (size >= options().max_results()) {
+      if (size > options().max_results()) result_array_.pop_back();
+      distance_limit_ = GetDistanceLimit(result_array_.back().distance());
+    }
   } else {
     // Add this edge to result_set_.  Note that even if we already have enough
     // edges, we can't erase an element before insertion because the "new"
@@ -870,8 +995,7 @@ void S2ClosestEdgeQueryBase<Distance>::AddResult(const Result& result) {
       if (size > options().max_results()) {
         result_set_.erase(--result_set_.end());
       }
-      distance_limit_ = (--result_set_.end())->distance() -
-                        options().max_error();
+      distance_limit_ = GetDistanceLimit((--result_set_.end())->distance());
     }
   }
 }
@@ -898,19 +1022,6 @@ void S2ClosestEdgeQueryBase<Distance>::ProcessEdges(const QueueEntry& entry) {
   }
 }
 
-// Enqueue the given cell id.
-// REQUIRES: iter_ is positioned at a cell contained by "id".
-template <class Distance>
-inline void S2ClosestEdgeQueryBase<Distance>::ProcessOrEnqueue(
-    S2CellId id) {
-  S2_DCHECK(id.contains(iter_.id()));
-  if (iter_.id() == id) {
-    ProcessOrEnqueue(id, &iter_.cell());
-  } else {
-    ProcessOrEnqueue(id, nullptr);
-  }
-}
-
 // Add the given cell id to the queue.  "index_cell" is the corresponding
 // S2ShapeIndexCell, or nullptr if "id" is not an index cell.
 //
@@ -918,24 +1029,70 @@ inline void S2ClosestEdgeQueryBase<Distance>::ProcessOrEnqueue(
 template <class Distance>
 void S2ClosestEdgeQueryBase<Distance>::ProcessOrEnqueue(
     S2CellId id, const S2ShapeIndexCell* index_cell) {
-  if (index_cell) {
-    // If this index cell has only a few edges, then it is faster to check
-    // them directly rather than computing the minimum distance to the S2Cell
-    // and inserting it into the queue.
-    static const int kMinEdgesToEnqueue = 10;
-    int num_edges = CountEdges(index_cell);
-    if (num_edges == 0) return;
-    if (num_edges < kMinEdgesToEnqueue) {
-      // Set "distance" to zero to avoid the expense of computing it.
-      ProcessEdges(QueueEntry(Distance::Zero(), id, index_cell));
-      return;
-    }
-  }
+  if (MaybeProcessEdges(id, index_cell)) return;
+
   // Otherwise compute the minimum distance to any point in the cell and add
   // it to the priority queue.
   S2Cell cell(id);
   Distance distance = distance_limit_;
   if (!target_->UpdateMinDistance(cell, &distance)) return;
+  Enqueue(id, index_cell, distance);
+}
+
+// If "index_cell" is non-null and has only a few edges, processes them and
+// returns true.  Also returns true if "index_cell" has no edges.  Otherwise
+// returns false, indicating that the cell should be enqueued.
+template <class Distance>
+inline bool S2ClosestEdgeQueryBase<Distance>::MaybeProcessEdges(
+    S2CellId id, const S2ShapeIndexCell* index_cell) {
+  if (index_cell == nullptr) return false;
+
+  // If this index cell has only a few edges, then it is faster to check
+  // them directly rather than computing the minimum distance to the S2Cell
+  // and inserting it into the queue.
+  static const int kMinEdgesToEnqueue = 10;
+  int num_edges = CountEdges(index_cell);
+  if (num_edges == 0) return true;
+  if (num_edges < kMinEdgesToEnqueue) {
+    // Set "distance" to zero to avoid the expense of computing it.
+    ProcessEdges(QueueEntry(Distance::Zero(), id, index_cell));
+    return true;
+  }
+  return false;
+}
+
+// Enqueues the children of "id" for which pending[k] is true, where
+// "child_cells" are the corresponding S2ShapeIndexCells (or nullptr).  When
+// several children are pending it is cheaper to compute their distances
+// together, since the children share vertices and edges.
+template <class Distance>
+void S2ClosestEdgeQueryBase<Distance>::EnqueueChildren(
+    S2CellId id, const S2ShapeIndexCell* child_cells[4],
+    const bool pending[4], int num_pending) {
+  if (num_pending == 0) return;
+  if (num_pending == 1) {
+    for (int k = 0; k < 4; ++k) {
+      if (pending[k]) ProcessOrEnqueue(id.child(k), child_cells[k]);
+    }
+    return;
+  }
+  // No distance can be less than Zero(), so the target may skip children
+  // whose distance is initialized to that value.
+  Distance distances[4];
+  for (int k = 0; k < 4; ++k) {
+    distances[k] = pending[k] ? distance_limit_ : Distance::Zero();
+  }
+  target_->UpdateChildMinDistances(S2Cell(id), distances);
+  for (int k = 0; k < 4; ++k) {
+    if (pending[k] && distances[k] < distance_limit_) {
+      Enqueue(id.child(k), child_cells[k], distances[k]);
+    }
+  }
+}
+
+template <class Distance>
+inline void S2ClosestEdgeQueryBase<Distance>::Enqueue(
+    S2CellId id, const S2ShapeIndexCell* index_cell, Distance distance) {
   if (use_conservative_cell_distance_) {
     // Ensure that "distance" is a lower bound on the true distance to the cell.
     distance = distance - options().max_error();  // operator-=() not defined.
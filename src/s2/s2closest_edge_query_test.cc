@@ -34,6 +34,7 @@
 #include "s2/s2metrics.h"
 #include "s2/s2point_vector_shape.h"
 #include "s2/s2polygon.h"
+#include "s2/s2polyline.h"
 #include "s2/s2predicates.h"
 #include "s2/s2shapeutil_coding.h"
 #include "s2/s2testing.h"
@@ -196,6 +197,27 @@ TEST(S2ClosestEdgeQuery, TargetPolygonContainingIndexedPoints) {
   EXPECT_EQ(3, results[1].edge_id());  // 3:13
 }
 
+TEST(S2ClosestEdgeQuery, TargetPointsInsideSeveralIndexedPolygons) {
+  // Every target point is contained by all three polygons, so each polygon
+  // is visited several times but must be reported only once.
+  auto index = MakeIndexOrDie(
+      "# # 0:0, 0:10, 10:10, 10:0 | 1:1, 1:9, 9:9, 9:1 | 2:2, 2:8, 8:8, 8:2");
+  auto target_index = MakeIndexOrDie("3:3 | 4:4 | 5:5 | 6:6 | 7:7 # #");
+  S2ClosestEdgeQuery::ShapeIndexTarget target(target_index.get());
+  S2ClosestEdgeQuery::Options options;
+  options.set_include_interiors(true);
+  options.set_max_distance(S1Angle::Degrees(0.5));
+  S2ClosestEdgeQuery query(index.get(), options);
+  auto results = query.FindClosestEdges(&target);
+  ASSERT_EQ(3, results.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, results[i].shape_id());
+    EXPECT_TRUE(results[i].is_interior());
+  }
+  query.mutable_options()->set_max_results(2);
+  EXPECT_EQ(2, query.FindClosestEdges(&target).size());
+}
+
 TEST(S2ClosestEdgeQuery, EmptyTargetOptimized) {
   // Ensure that the optimized algorithm handles empty targets when a distance
   // limit is specified.
@@ -471,6 +493,79 @@ static void TestWithIndexFactory(const s2testing::ShapeIndexFactory& factory,
   }
 }
 
+TEST(S2ClosestEdgeQuery, RepeatedQueriesReuseStorage) {
+  // A query object reuses its internal storage across calls.  Check that
+  // interleaving queries that use the small result vector (max_results() <=
+  // 16) and the btree_set, with and without a distance limit, gives the same
+  // results as a new query object each time.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(1000);
+  auto loop = fractal.MakeLoop(S2Testing::GetRandomFrameAt(S2Point(1, 0, 0)),
+                               S1Angle::Degrees(10));
+  vector<S2Point> vertices(&loop->vertex(0),
+                           &loop->vertex(0) + loop->num_vertices());
+  MutableS2ShapeIndex index;
+  index.Add(make_unique<S2Polyline::OwningShape>(
+      make_unique<S2Polyline>(vertices)));
+  S2ClosestEdgeQuery query(&index);
+  vector<S2ClosestEdgeQuery::Result> actual, expected;
+  for (int i = 0; i < 100; ++i) {
+    S2ClosestEdgeQuery::Options options;
+    options.set_max_results(vector<int>{1, 3, 20}[i % 3]);
+    if (i % 2) options.set_max_distance(S1Angle::Degrees(2));
+    *query.mutable_options() = options;
+    S2ClosestEdgeQuery::PointTarget target(S2Testing::SamplePoint(
+        S2Cap(S2Point(1, 0, 0), S1Angle::Degrees(15))));
+    query.FindClosestEdges(&target, &actual);
+    S2ClosestEdgeQuery(&index, options).FindClosestEdges(&target, &expected);
+    EXPECT_EQ(expected, actual);
+  }
+}
+
+TEST(S2ClosestEdgeQuery, ReInitDetectsNewPolygons) {
+  // Whether the index contains polygons is cached until ReInit() is called.
+  MutableS2ShapeIndex index;
+  index.Add(make_unique<S2Polyline::OwningShape>(
+      s2textformat::MakePolylineOrDie("0:0, 0:10")));
+  S2ClosestEdgeQuery query(&index);
+  query.mutable_options()->set_include_interiors(true);
+  S2ClosestEdgeQuery::PointTarget target(MakePointOrDie("5:5"));
+  EXPECT_LT(S1ChordAngle::Zero(), query.GetDistance(&target));
+  index.Add(make_unique<S2Polygon::OwningShape>(
+      MakePolygonOrDie("3:3, 3:7, 7:7, 7:3")));
+  query.ReInit();
+  EXPECT_EQ(S1ChordAngle::Zero(), query.GetDistance(&target));
+}
+
+TEST(S2ClosestEdgeQuery, MaxRelativeError) {
+  // Checks that each result is within a factor of (1 + max_relative_error())
+  // of the corresponding exact result.
+  const double kMaxRelativeError = 0.1;
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Cap index_cap(S2Testing::RandomPoint(), kTestCapRadius);
+  MutableS2ShapeIndex index;
+  s2testing::FractalLoopShapeIndexFactory().AddEdges(index_cap, 1000, &index);
+  S2ClosestEdgeQuery::Options options;
+  options.set_max_results(5);
+  options.set_include_interiors(false);
+  S2ClosestEdgeQuery exact_query(&index, options);
+  options.set_max_relative_error(kMaxRelativeError);
+  S2ClosestEdgeQuery query(&index, options);
+  S2Cap query_cap(index_cap.center(), 4 * kTestCapRadius);
+  for (int i = 0; i < 100; ++i) {
+    S2ClosestEdgeQuery::PointTarget target(S2Testing::SamplePoint(query_cap));
+    auto expected = exact_query.FindClosestEdges(&target);
+    auto actual = query.FindClosestEdges(&target);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (int j = 0; j < actual.size(); ++j) {
+      EXPECT_LE(actual[j].distance().ToAngle().radians(),
+                (1 + kMaxRelativeError) *
+                expected[j].distance().ToAngle().radians() + 1e-15);
+    }
+  }
+}
+
 static const int kNumIndexes = 50;
 static const int kNumEdges = 100;
 static const int kNumQueries = 200;
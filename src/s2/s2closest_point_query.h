@@ -83,6 +83,7 @@ class S2ClosestPointQueryOptions :
 
   // Inherited options (see s2closest_point_query_base.h for details):
   using Base::set_max_results;
+  using Base::set_max_relative_error;
   using Base::set_region;
   using Base::set_use_brute_force;
 };
@@ -418,7 +419,7 @@ inline void S2ClosestPointQuery<Data>::FindClosestPoints(
 template <class Data>
 inline typename S2ClosestPointQuery<Data>::Result
 S2ClosestPointQuery<Data>::FindClosestPoint(Target* target) {
-  static_assert(sizeof(Options) <= 32, "Consider not copying Options here");
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
   Options tmp_options = options_;
   tmp_options.set_max_results(1);
   return base_.FindClosestPoint(target, tmp_options);
@@ -432,7 +433,7 @@ inline S1ChordAngle S2ClosestPointQuery<Data>::GetDistance(Target* target) {
 template <class Data>
 bool S2ClosestPointQuery<Data>::IsDistanceLess(
     Target* target, S1ChordAngle limit) {
-  static_assert(sizeof(Options) <= 32, "Consider not copying Options here");
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
   Options tmp_options = options_;
   tmp_options.set_max_results(1);
   tmp_options.set_max_distance(limit);
@@ -443,7 +444,7 @@ bool S2ClosestPointQuery<Data>::IsDistanceLess(
 template <class Data>
 bool S2ClosestPointQuery<Data>::IsDistanceLessOrEqual(
     Target* target, S1ChordAngle limit) {
-  static_assert(sizeof(Options) <= 32, "Consider not copying Options here");
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
   Options tmp_options = options_;
   tmp_options.set_max_results(1);
   tmp_options.set_inclusive_max_distance(limit);
@@ -454,7 +455,7 @@ bool S2ClosestPointQuery<Data>::IsDistanceLessOrEqual(
 template <class Data>
 bool S2ClosestPointQuery<Data>::IsConservativeDistanceLessOrEqual(
     Target* target, S1ChordAngle limit) {
-  static_assert(sizeof(Options) <= 32, "Consider not copying Options here");
+  static_assert(sizeof(Options) <= 40, "Consider not copying Options here");
   Options tmp_options = options_;
   tmp_options.set_max_results(1);
   tmp_options.set_conservative_max_distance(limit);
@@ -20,10 +20,12 @@
 #ifndef S2_S2CLOSEST_POINT_QUERY_BASE_H_
 #define S2_S2CLOSEST_POINT_QUERY_BASE_H_
 
+#include <algorithm>
 #include <vector>
 
 #include "s2/base/logging.h"
 #include "s2/third_party/absl/container/inlined_vector.h"
+#include "s2/s1angle.h"
 #include "s2/s1chord_angle.h"
 #include "s2/s2cap.h"
 #include "s2/s2cell_id.h"
@@ -91,6 +93,14 @@ class S2ClosestPointQueryBaseOptions {
   Delta max_error() const;
   void set_max_error(Delta max_error);
 
+  // Like max_error(), except that the allowable error is a fraction of the
+  // distance to the result being replaced (see S2ClosestEdgeQueryBase).
+  //
+  // REQUIRES: max_relative_error >= 0
+  // DEFAULT: 0
+  double max_relative_error() const;
+  void set_max_relative_error(double max_relative_error);
+
   // Specifies that points must be contained by the given S2Region.  "region"
   // is owned by the caller and must persist during the lifetime of this
   // object.  The value may be changed between calls to FindClosestPoints(),
@@ -114,6 +124,7 @@ class S2ClosestPointQueryBaseOptions {
  private:
   Distance max_distance_ = Distance::Infinity();
   Delta max_error_ = Delta::Zero();
+  double max_relative_error_ = 0;
   const S2Region* region_ = nullptr;
   int max_results_ = kMaxMaxResults;
   bool use_brute_force_ = false;
@@ -254,7 +265,11 @@ class S2ClosestPointQueryBase {
   void InitCovering();
   void AddInitialRange(S2CellId first_id, S2CellId last_id);
   void MaybeAddResult(const PointData* point_data);
+  Distance GetDistanceLimit(Distance distance) const;
   bool ProcessOrEnqueue(S2CellId id, Iterator* iter, bool seek);
+  bool MaybeProcessPoints(S2CellId id, Iterator* iter, bool seek);
+  void EnqueueChildren(S2CellId id, const bool pending[4], int num_pending);
+  void Enqueue(S2CellId id, Distance distance);
 
   const Index* index_;
   const Options* options_;
@@ -371,6 +386,19 @@ inline void S2ClosestPointQueryBaseOptions<Distance>::set_max_error(
   max_error_ = max_error;
 }
 
+template <class Distance>
+inline double
+S2ClosestPointQueryBaseOptions<Distance>::max_relative_error() const {
+  return max_relative_error_;
+}
+
+template <class Distance>
+inline void S2ClosestPointQueryBaseOptions<Distance>::set_max_relative_error(
+    double max_relative_error) {
+  S2_DCHECK_GE(max_relative_error, 0);
+  max_relative_error_ = max_relative_error;
+}
+
 template <class Distance>
 inline const S2Region* S2ClosestPointQueryBaseOptions<Distance>::region()
     const {
@@ -557,11 +585,17 @@ void S2ClosestPointQueryBase<Distance, Data>::FindClosestPointsOptimized() {
     S2CellId child = entry.id.child_begin();
     // We already know that it has too many points, so process its children.
     // Each child may either be processed directly or enqueued again.  The
-    // loop is optimized so that we don't seek unnecessarily.
+    // loop is optimized so that we don't seek unnecessarily.  The distances
+    // to the children that are enqueued are computed together.
     bool seek = true;
+    bool pending[4];
+    int num_pending = 0;
     for (int i = 0; i < 4; ++i, child = child.next()) {
-      seek = ProcessOrEnqueue(child, &iter_, seek);
+      pending[i] = !MaybeProcessPoints(child, &iter_, seek);
+      if (pending[i]) ++num_pending;
+      seek = pending[i];
     }
+    EnqueueChildren(entry.id, pending, num_pending);
   }
 }
 
@@ -688,6 +722,15 @@ void S2ClosestPointQueryBase<Distance, Data>::AddInitialRange(
   index_covering_.push_back(first_id.parent(level));
 }
 
+// Returns the distance limit to use once the worst result to be returned is
+// at the given distance (see S2::GetDistanceLimit).
+template <class Distance, class Data>
+inline Distance S2ClosestPointQueryBase<Distance, Data>::GetDistanceLimit(
+    Distance distance) const {
+  return S2::GetDistanceLimit(distance, options().max_error(),
+                              options().max_relative_error());
+}
+
 template <class Distance, class Data>
 void S2ClosestPointQueryBase<Distance, Data>::MaybeAddResult(
     const PointData* point_data) {
@@ -701,7 +744,7 @@ void S2ClosestPointQueryBase<Distance, Data>::MaybeAddResult(
   if (options().max_results() == 1) {
     // Optimization for the common case where only the closest point is wanted.
     result_singleton_ = result;
-    distance_limit_ = result.distance() - options().max_error();
+    distance_limit_ = GetDistanceLimit(result.distance());
   } else if (options().max_results() == Options::kMaxMaxResults) {
     result_vector_.push_back(result);  // Sort/unique at end.
   } else {
@@ -714,7 +757,7 @@ void S2ClosestPointQueryBase<Distance, Data>::MaybeAddResult(
     }
     result_set_.push(result);
     if (result_set_.size() >= options().max_results()) {
-      distance_limit_ = result_set_.top().distance() - options().max_error();
+      distance_limit_ = GetDistanceLimit(result_set_.top().distance());
     }
   }
 }
@@ -729,31 +772,38 @@ void S2ClosestPointQueryBase<Distance, Data>::MaybeAddResult(
 template <class Distance, class Data>
 bool S2ClosestPointQueryBase<Distance, Data>::ProcessOrEnqueue(
     S2CellId id, Iterator* iter, bool seek) {
+  if (MaybeProcessPoints(id, iter, seek)) return false;
+
+  // Otherwise compute the minimum distance to any point in the cell and add
+  // it to the priority queue.
+  Distance distance = distance_limit_;
+  if (target_->UpdateMinDistance(S2Cell(id), &distance)) {
+    Enqueue(id, distance);
+  }
+  return true;  // Seek to next child.
+}
+
+// Processes the points in the given cell immediately if there are only a few
+// of them, in which case "iter" is left positioned at the next cell in
+// S2CellId order, and returns true.  Otherwise returns false, indicating
+// that the cell should be enqueued.  "seek" is as for ProcessOrEnqueue().
+template <class Distance, class Data>
+bool S2ClosestPointQueryBase<Distance, Data>::MaybeProcessPoints(
+    S2CellId id, Iterator* iter, bool seek) {
   if (seek) iter->Seek(id.range_min());
   if (id.is_leaf()) {
     // Leaf cells can't be subdivided.
     for (; !iter->done() && iter->id() == id; iter->Next()) {
       MaybeAddResult(&iter->point_data());
     }
-    return false;  // No need to seek to next child.
+    return true;
   }
   S2CellId last = id.range_max();
   int num_points = 0;
   for (; !iter->done() && iter->id() <= last; iter->Next()) {
     if (num_points == kMinPointsToEnqueue - 1) {
-      // This cell has too many points (including this one), so enqueue it.
-      S2Cell cell(id);
-      Distance distance = distance_limit_;
-      // We check "region_" second because it may be relatively expensive.
-      if (target_->UpdateMinDistance(cell, &distance) &&
-          (!options().region() || options().region()->MayIntersect(cell))) {
-        if (use_conservative_cell_distance_) {
-          // Ensure that "distance" is a lower bound on distance to the cell.
-          distance = distance - options().max_error();
-        }
-        queue_.push(QueueEntry(distance, id));
-      }
-      return true;  // Seek to next child.
+      // This cell has too many points (including this one).
+      return false;
     }
     tmp_point_data_[num_points++] = &iter->point_data();
   }
@@ -761,7 +811,53 @@ bool S2ClosestPointQueryBase<Distance, Data>::ProcessOrEnqueue(
   for (int i = 0; i < num_points; ++i) {
     MaybeAddResult(tmp_point_data_[i]);
   }
-  return false;  // No need to seek to next child.
+  return true;
+}
+
+// Enqueues the children of "id" for which pending[k] is true.  When several
+// children are pending it is cheaper to compute their distances together,
+// since the children share vertices and edges.
+template <class Distance, class Data>
+void S2ClosestPointQueryBase<Distance, Data>::EnqueueChildren(
+    S2CellId id, const bool pending[4], int num_pending) {
+  if (num_pending == 0) return;
+  // No distance can be less than Zero(), so the target may skip children
+  // whose distance is initialized to that value.
+  Distance distances[4];
+  for (int k = 0; k < 4; ++k) {
+    distances[k] = pending[k] ? distance_limit_ : Distance::Zero();
+  }
+  if (num_pending == 1) {
+    for (int k = 0; k < 4; ++k) {
+      if (pending[k]) {
+        target_->UpdateMinDistance(S2Cell(id.child(k)), &distances[k]);
+      }
+    }
+  } else {
+    target_->UpdateChildMinDistances(S2Cell(id), distances);
+  }
+  for (int k = 0; k < 4; ++k) {
+    if (pending[k] && distances[k] < distance_limit_) {
+      Enqueue(id.child(k), distances[k]);
+    }
+  }
+}
+
+// Adds the given cell to the priority queue, where "distance" is the minimum
+// distance from the target to any point in the cell.
+template <class Distance, class Data>
+inline void S2ClosestPointQueryBase<Distance, Data>::Enqueue(
+    S2CellId id, Distance distance) {
+  // We check "region_" after computing the distance because it may be
+  // relatively expensive.
+  if (options().region() && !options().region()->MayIntersect(S2Cell(id))) {
+    return;
+  }
+  if (use_conservative_cell_distance_) {
+    // Ensure that "distance" is a lower bound on distance to the cell.
+    distance = distance - options().max_error();
+  }
+  queue_.push(QueueEntry(distance, id));
 }
 
 #endif  // S2_S2CLOSEST_POINT_QUERY_BASE_H_
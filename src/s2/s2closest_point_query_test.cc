@@ -278,6 +278,32 @@ static void TestWithIndexFactory(const PointIndexFactory& factory,
   }
 }
 
+TEST(S2ClosestPointQueryTest, MaxRelativeError) {
+  // Checks that each result is within a factor of (1 + max_relative_error())
+  // of the corresponding exact result.
+  const double kMaxRelativeError = 0.1;
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Cap index_cap(S2Testing::RandomPoint(), kTestCapRadius);
+  TestIndex index;
+  FractalPointIndexFactory().AddPoints(index_cap, 1000, &index);
+  TestQuery exact_query(&index);
+  exact_query.mutable_options()->set_max_results(5);
+  TestQuery query(&index, exact_query.options());
+  query.mutable_options()->set_max_relative_error(kMaxRelativeError);
+  S2Cap query_cap(index_cap.center(), 4 * kTestCapRadius);
+  for (int i = 0; i < 100; ++i) {
+    TestQuery::PointTarget target(S2Testing::SamplePoint(query_cap));
+    auto expected = exact_query.FindClosestPoints(&target);
+    auto actual = query.FindClosestPoints(&target);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (int j = 0; j < actual.size(); ++j) {
+      EXPECT_LE(actual[j].distance().ToAngle().radians(),
+                (1 + kMaxRelativeError) *
+                expected[j].distance().ToAngle().radians() + 1e-15);
+    }
+  }
+}
+
 static const int kNumIndexes = 10;
 static const int kNumPoints = 1000;
 static const int kNumQueries = 50;
@@ -19,13 +19,21 @@
 // Graham scan (see https://en.wikipedia.org/wiki/Graham_scan).  The time
 // complexity is O(n log n), and the space required is O(n).  In fact only the
 // call to "sort" takes O(n log n) time; the rest of the algorithm is linear.
+// Before sorting, most points that are not hull vertices are discarded in
+// linear time using the Akl-Toussaint heuristic.
 //
 // Demonstration of the algorithm and code:
 // en.wikibooks.org/wiki/Algorithm_Implementation/Geometry/Convex_hull/Monotone_chain
 
 #include "s2/s2convex_hull_query.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
 #include "s2/third_party/absl/memory/memory.h"
+#include "s2/s2parallel_internal.h"
 #include "s2/s2pointutil.h"
 #include "s2/s2predicates.h"
 
@@ -42,6 +50,13 @@ void S2ConvexHullQuery::AddPoint(const S2Point& point) {
   points_.push_back(point);
 }
 
+void S2ConvexHullQuery::AddPoints(absl::Span<const S2Point> points) {
+  for (const S2Point& point : points) {
+    bound_.AddPoint(point);
+  }
+  points_.insert(points_.end(), points.begin(), points.end());
+}
+
 void S2ConvexHullQuery::AddPolyline(const S2Polyline& polyline) {
   bound_ = bound_.Union(polyline.GetRectBound());
   for (int i = 0; i < polyline.num_vertices(); ++i) {
@@ -100,7 +115,18 @@ class OrderedCcwAround {
   S2Point center_;
 };
 
-unique_ptr<S2Loop> S2ConvexHullQuery::GetConvexHull() {
+// Divides the range [0, n) into "num_chunks" contiguous ranges of nearly
+// equal size and calls "fn(i, begin, end)" for each range i, using one
+// thread per range.
+template <class Function>
+static void ForEachChunk(size_t n, int num_chunks, const Function& fn) {
+  S2::internal::ParallelForChunks(
+      n, num_chunks, num_chunks, [&fn](int, int i, int begin, int end) {
+        fn(i, begin, end);
+      });
+}
+
+unique_ptr<S2Loop> S2ConvexHullQuery::GetConvexHull(int num_threads) {
   S2Cap cap = GetCapBound();
   if (cap.height() >= 1) {
     // The bounding cap is not convex.  The current bounding cap
@@ -118,8 +144,15 @@ unique_ptr<S2Loop> S2ConvexHullQuery::GetConvexHull() {
   // ensures that as we scan through the points, each new point can only
   // belong at the end of the chain (i.e., the chain is monotone in terms of
   // the angle around O from the starting point).
+  //
+  // Multiple threads are only worthwhile when there are many points.
+  static const int kMinPointsPerThread = 10000;
+  num_threads = std::max<int>(1, std::min<size_t>(
+      S2::internal::GetNumThreads(num_threads),
+      points_.size() / kMinPointsPerThread));
+  RemoveInteriorPoints(cap.center(), num_threads);
   S2Point origin = cap.center().Ortho();
-  std::sort(points_.begin(), points_.end(), OrderedCcwAround(origin));
+  SortPoints(origin, num_threads);
 
   // Remove duplicates.  We need to do this before checking whether there are
   // fewer than 3 points.
@@ -156,6 +189,123 @@ unique_ptr<S2Loop> S2ConvexHullQuery::GetConvexHull() {
   return make_unique<S2Loop>(lower);
 }
 
+// Discards points that are strictly inside the convex hull of a few extreme
+// points.  This is the Akl-Toussaint heuristic, which typically discards
+// nearly all the points of large inputs in linear time.  The points are
+// projected onto the plane tangent to the sphere at "center" using the
+// gnomonic projection (which maps geodesics to straight lines), and the
+// extreme points in 8 directions are found.  These points are vertices of
+// the convex hull, so any point strictly inside the polygon that they form
+// is strictly inside the hull and cannot be one of its vertices.
+//
+// REQUIRES: All points are within 90 degrees of "center".
+void S2ConvexHullQuery::RemoveInteriorPoints(const S2Point& center,
+                                             int num_threads) {
+  static const int kNumDirections = 8;
+  static const int kMinPoints = 100;
+  if (points_.size() < kMinPoints) return;
+  S2Point x = S2::Ortho(center);
+  S2Point y = center.CrossProd(x);
+  S2Point dirs[kNumDirections];
+  for (int k = 0; k < kNumDirections; ++k) {
+    double angle = k * (M_PI / 4);
+    dirs[k] = cos(angle) * x + sin(angle) * y;
+  }
+  // Find the extreme point in each direction within each range of points,
+  // and then combine the results.
+  vector<std::array<int, kNumDirections>> extremes(num_threads);
+  ForEachChunk(points_.size(), num_threads,
+               [this, &center, &dirs, &extremes](int i, size_t begin,
+                                                 size_t end) {
+    std::array<double, kNumDirections> best;
+    best.fill(-std::numeric_limits<double>::infinity());
+    for (size_t j = begin; j < end; ++j) {
+      const S2Point& p = points_[j];
+      double inv_z = 1 / p.DotProd(center);
+      for (int k = 0; k < kNumDirections; ++k) {
+        double value = p.DotProd(dirs[k]) * inv_z;
+        if (value > best[k]) {
+          best[k] = value;
+          extremes[i][k] = j;
+        }
+      }
+    }
+  });
+  vector<S2Point> polygon;
+  for (int k = 0; k < kNumDirections; ++k) {
+    int best_index = extremes[0][k];
+    double best = -std::numeric_limits<double>::infinity();
+    for (int i = 0; i < num_threads; ++i) {
+      const S2Point& p = points_[extremes[i][k]];
+      double value = p.DotProd(dirs[k]) / p.DotProd(center);
+      if (value > best) {
+        best = value;
+        best_index = extremes[i][k];
+      }
+    }
+    const S2Point& p = points_[best_index];
+    if (polygon.empty() || (p != polygon.back() && p != polygon.front())) {
+      polygon.push_back(p);
+    }
+  }
+  if (polygon.size() < 3) return;
+
+  // Now remove the points strictly inside the polygon formed by the extreme
+  // points.  (If this polygon is not quite convex due to numerical errors,
+  // then we only remove points strictly to the left of all its edges, which
+  // are still strictly inside the polygon.)  Each range of points is
+  // compacted in place and then the ranges are concatenated.
+  const int n = polygon.size();
+  vector<size_t> range_end(num_threads);
+  ForEachChunk(points_.size(), num_threads,
+               [this, &polygon, &range_end, n](int i, size_t begin,
+                                               size_t end) {
+    size_t out = begin;
+    for (size_t j = begin; j < end; ++j) {
+      const S2Point& p = points_[j];
+      int k = 0;
+      while (k < n && s2pred::Sign(polygon[k], polygon[(k + 1) % n], p) > 0) {
+        ++k;
+      }
+      if (k < n) points_[out++] = p;
+    }
+    range_end[i] = out;
+  });
+  size_t out = range_end[0];
+  for (int i = 1; i < num_threads; ++i) {
+    size_t begin = points_.size() * i / num_threads;
+    out = std::move(points_.begin() + begin, points_.begin() + range_end[i],
+                    points_.begin() + out) - points_.begin();
+  }
+  points_.resize(out);
+}
+
+// Sorts the points in CCW order around "origin".  Ranges of points are
+// sorted in parallel and then merged in pairs.
+void S2ConvexHullQuery::SortPoints(const S2Point& origin, int num_threads) {
+  OrderedCcwAround order(origin);
+  if (num_threads == 1) {
+    std::sort(points_.begin(), points_.end(), order);
+    return;
+  }
+  const size_t n = points_.size();
+  ForEachChunk(n, num_threads, [this, &order](int i, size_t begin,
+                                              size_t end) {
+    std::sort(points_.begin() + begin, points_.begin() + end, order);
+  });
+  for (int width = 1; width < num_threads; width *= 2) {
+    int num_merges = (num_threads + 2 * width - 1) / (2 * width);
+    ForEachChunk(num_merges, num_merges, [&](int i, size_t, size_t) {
+      int first = 2 * i * width;
+      int middle = std::min(first + width, num_threads);
+      int last = std::min(first + 2 * width, num_threads);
+      std::inplace_merge(points_.begin() + n * first / num_threads,
+                         points_.begin() + n * middle / num_threads,
+                         points_.begin() + n * last / num_threads, order);
+    });
+  }
+}
+
 // Iterate through the given points, selecting the maximal subset of points
 // such that the edge chain makes only left (CCW) turns.
 void S2ConvexHullQuery::GetMonotoneChain(vector<S2Point>* output) {
@@ -21,6 +21,7 @@
 #include <memory>
 #include <vector>
 
+#include "s2/third_party/absl/types/span.h"
 #include "s2/_fp_contract_off.h"
 #include "s2/s2cap.h"
 #include "s2/s2latlng_rect.h"
@@ -64,6 +65,10 @@ class S2ConvexHullQuery {
   // Add a point to the input geometry.
   void AddPoint(const S2Point& point);
 
+  // Add a collection of points to the input geometry.  This is equivalent to
+  // calling AddPoint() for each point but is faster for large inputs.
+  void AddPoints(absl::Span<const S2Point> points);
+
   // Add a polyline to the input geometry.
   void AddPolyline(const S2Polyline& polyline);
 
@@ -93,9 +98,14 @@ class S2ConvexHullQuery {
   //
   // Note that this method does not clear the geometry; you can continue
   // adding to it and call this method again if desired.
-  std::unique_ptr<S2Loop> GetConvexHull();
+  //
+  // Large inputs may be processed using up to "num_threads" threads (where 0
+  // means one thread per hardware core).
+  std::unique_ptr<S2Loop> GetConvexHull(int num_threads = 1);
 
  private:
+  void RemoveInteriorPoints(const S2Point& center, int num_threads);
+  void SortPoints(const S2Point& origin, int num_threads);
   void GetMonotoneChain(std::vector<S2Point>* output);
   std::unique_ptr<S2Loop> GetSinglePointLoop(const S2Point& p);
   std::unique_ptr<S2Loop> GetSingleEdgeLoop(const S2Point& a, const S2Point& b);
@@ -21,6 +21,7 @@
 #include <memory>
 
 #include <gtest/gtest.h>
+#include "s2/s2pointutil.h"
 #include "s2/s2testing.h"
 #include "s2/s2text_format.h"
 
@@ -205,4 +206,52 @@ TEST(S2ConvexHullQueryTest, PointsInsideHull) {
   }
 }
 
+TEST(S2ConvexHullQueryTest, AddPoints) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Cap cap(S2Testing::RandomPoint(), S1Angle::Degrees(10));
+  vector<S2Point> points;
+  for (int i = 0; i < 1000; ++i) {
+    points.push_back(S2Testing::SamplePoint(cap));
+  }
+  S2ConvexHullQuery query1, query2;
+  for (const S2Point& p : points) query1.AddPoint(p);
+  query2.AddPoints(points);
+  EXPECT_EQ(query1.GetCapBound(), query2.GetCapBound());
+  unique_ptr<S2Loop> hull1(query1.GetConvexHull());
+  unique_ptr<S2Loop> hull2(query2.GetConvexHull());
+  EXPECT_TRUE(hull1->BoundaryEquals(hull2.get()));
+}
+
+TEST(S2ConvexHullQueryTest, ManyPointsMultipleThreads) {
+  // Checks that discarding interior points and sorting in parallel do not
+  // change the result.  The points are sampled from the disc so that most
+  // of them are discarded, and from a thin annulus so that most are not.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  for (double min_fraction : {0.0, 0.999}) {
+    S2Point center = S2Testing::RandomPoint();
+    Matrix3x3_d frame = S2Testing::GetRandomFrameAt(center);
+    vector<S2Point> points;
+    for (int i = 0; i < 100000; ++i) {
+      double r = 0.1 * sqrt(min_fraction + (1 - min_fraction) *
+                            S2Testing::rnd.RandDouble());
+      double theta = 2 * M_PI * S2Testing::rnd.RandDouble();
+      points.push_back(S2::FromFrame(
+          frame, S2Point(r * cos(theta), r * sin(theta), 1).Normalize()));
+    }
+    S2ConvexHullQuery expected_query;
+    for (const S2Point& p : points) expected_query.AddPoint(p);
+    unique_ptr<S2Loop> expected(expected_query.GetConvexHull());
+    for (const S2Point& p : points) {
+      ASSERT_TRUE(expected->Contains(p) || LoopHasVertex(*expected, p));
+    }
+    for (int num_threads : {3, 4, 0}) {
+      S2ConvexHullQuery query;
+      query.AddPoints(points);
+      unique_ptr<S2Loop> actual(query.GetConvexHull(num_threads));
+      EXPECT_TRUE(actual->BoundaryEquals(expected.get()))
+          << "num_threads=" << num_threads;
+    }
+  }
+}
+
 }  // namespace
@@ -18,6 +18,10 @@
 #ifndef S2_S2DISTANCE_TARGET_H_
 #define S2_S2DISTANCE_TARGET_H_
 
+#include <algorithm>
+
+#include "s2/s1angle.h"
+#include "s2/s1chord_angle.h"
 #include "s2/s2cap.h"
 #include "s2/s2cell.h"
 #include "s2/s2shape_index.h"
@@ -107,6 +111,24 @@ class S2DistanceTarget {
   // returns false.
   virtual bool UpdateMinDistance(const S2Cell& cell, Distance* min_dist) = 0;
 
+  // Equivalent to calling UpdateMinDistance(children[i], &min_dists[i]) for
+  // each of the four children of "parent" (in traversal order).  Since no
+  // distance is less than Distance::Zero(), children whose "min_dists" entry
+  // is Zero() may be skipped.  Targets whose distance to a cell can share
+  // work among the children of a cell (e.g., points) override this method
+  // to compute the four distances at once.
+  //
+  // REQUIRES: !parent.is_leaf()
+  virtual void UpdateChildMinDistances(const S2Cell& parent,
+                                       Distance min_dists[4]) {
+    S2Cell children[4];
+    parent.Subdivide(children);
+    for (int i = 0; i < 4; ++i) {
+      if (min_dists[i] == Distance::Zero()) continue;
+      UpdateMinDistance(children[i], &min_dists[i]);
+    }
+  }
+
   // Finds all polygons in the given "query_index" that completely contain a
   // connected component of the target geometry.  (For example, if the
   // target consists of 10 points, this method finds polygons that contain
@@ -162,4 +184,42 @@ class S2DistanceTarget {
   virtual int max_brute_force_index_size() const { return -1; }
 };
 
+namespace S2 {
+
+// Returns the limit used by distance queries (S2ClosestEdgeQueryBase, etc.)
+// to prune candidates once the worst result to be returned is at "distance".
+// Only candidates whose distance is less than the limit are considered.  The
+// limit allows either an absolute error of "max_error" or a relative error
+// of "max_relative_error", whichever is larger.
+//
+// The relative error r is measured using angles.  For minimum distances
+// (e.g., S2MinDistance) each result may be up to (1 + r) times further away
+// than the corresponding true result, while for maximum distances (e.g.,
+// S2MaxDistance) the true result may be up to (1 + r) times further away
+// than the reported one.
+//
+// REQUIRES: "distance" can be converted to an S1ChordAngle.
+template <class Distance>
+Distance GetDistanceLimit(Distance distance,
+                          typename Distance::Delta max_error,
+                          double max_relative_error) {
+  using Delta = typename Distance::Delta;
+  if (max_relative_error > 0) {
+    double r = max_relative_error;
+    S1ChordAngle chord_angle = static_cast<S1ChordAngle>(distance);
+    S1Angle angle = chord_angle.ToAngle();
+    // Subtracting an error decreases the angle for minimum distances, where
+    // a better result must be closer than angle / (1 + r), and increases it
+    // for maximum distances, where it must be further than angle * (1 + r).
+    Delta error(angle * r);
+    if (static_cast<S1ChordAngle>(distance - error) < chord_angle) {
+      error = Delta(angle * (r / (1 + r)));
+    }
+    max_error = std::max(max_error, error);
+  }
+  return distance - max_error;
+}
+
+}  // namespace S2
+
 #endif  // S2_S2DISTANCE_TARGET_H_
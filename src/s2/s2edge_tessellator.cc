@@ -17,9 +17,12 @@
 
 #include "s2/s2edge_tessellator.h"
 
+#include <algorithm>
 #include <cmath>
+#include "s2/third_party/absl/container/inlined_vector.h"
 #include "s2/s2edge_distances.h"
 #include "s2/s2latlng.h"
+#include "s2/s2parallel_internal.h"
 #include "s2/s2pointutil.h"
 
 using std::vector;
@@ -224,19 +227,32 @@ void S2EdgeTessellator::AppendProjected(
 // Given a geodesic edge AB, split the edge as necessary and append all
 // projected vertices except the first to "vertices".
 //
-// The maximum recursion depth is (M_PI / kMinTolerance()) < 45, and the
-// frame size is small so stack overflow should not be an issue.
-void S2EdgeTessellator::AppendProjected(const R2Point& pa, const S2Point& a,
-                                        const R2Point& pb_in, const S2Point& b,
+// The edge is subdivided iteratively rather than recursively.  "stack"
+// holds the right halves of the edges that still need to be processed; the
+// maximum depth is (M_PI / kMinTolerance()) < 45, so it rarely needs to
+// allocate memory.  The vertices are generated in the same order as a
+// recursive depth-first subdivision.
+void S2EdgeTessellator::AppendProjected(const R2Point& pa_in, const S2Point& a,
+                                        const R2Point& pb, const S2Point& b,
                                         vector<R2Point>* vertices) const {
-  R2Point pb = proj_.WrapDestination(pa, pb_in);
-  if (EstimateMaxError(pa, a, pb, b) <= scaled_tolerance_) {
-    vertices->push_back(pb);
-  } else {
-    S2Point mid = (a + b).Normalize();
-    R2Point pmid = proj_.WrapDestination(pa, proj_.Project(mid));
-    AppendProjected(pa, a, pmid, mid, vertices);
-    AppendProjected(pmid, mid, pb, b, vertices);
+  absl::InlinedVector<std::pair<R2Point, S2Point>, 16> stack;
+  stack.emplace_back(pb, b);
+  R2Point pa = pa_in;
+  S2Point a_cur = a;
+  while (!stack.empty()) {
+    R2Point pb_cur = proj_.WrapDestination(pa, stack.back().first);
+    const S2Point& b_cur = stack.back().second;
+    if (EstimateMaxError(pa, a_cur, pb_cur, b_cur) <= scaled_tolerance_) {
+      vertices->push_back(pb_cur);
+      pa = pb_cur;
+      a_cur = b_cur;
+      stack.pop_back();
+    } else {
+      S2Point mid = (a_cur + b_cur).Normalize();
+      R2Point pmid = proj_.WrapDestination(pa, proj_.Project(mid));
+      stack.back().first = pb_cur;
+      stack.emplace_back(pmid, mid);
+    }
   }
 }
 
@@ -261,16 +277,84 @@ void S2EdgeTessellator::AppendUnprojected(
 // Like AppendProjected, but interpolates a projected edge and appends the
 // corresponding points on the sphere.
 void S2EdgeTessellator::AppendUnprojected(
-    const R2Point& pa, const S2Point& a,
-    const R2Point& pb_in, const S2Point& b, vector<S2Point>* vertices) const {
+    const R2Point& pa_in, const S2Point& a,
+    const R2Point& pb, const S2Point& b, vector<S2Point>* vertices) const {
   // See notes above regarding measuring the interpolation error.
-  R2Point pb = proj_.WrapDestination(pa, pb_in);
-  if (EstimateMaxError(pa, a, pb, b) <= scaled_tolerance_) {
-    vertices->push_back(b);
+  absl::InlinedVector<std::pair<R2Point, S2Point>, 16> stack;
+  stack.emplace_back(pb, b);
+  R2Point pa = pa_in;
+  S2Point a_cur = a;
+  while (!stack.empty()) {
+    R2Point pb_cur = proj_.WrapDestination(pa, stack.back().first);
+    const S2Point& b_cur = stack.back().second;
+    if (EstimateMaxError(pa, a_cur, pb_cur, b_cur) <= scaled_tolerance_) {
+      vertices->push_back(b_cur);
+      pa = pb_cur;
+      a_cur = b_cur;
+      stack.pop_back();
+    } else {
+      R2Point pmid = proj_.Interpolate(0.5, pa, pb_cur);
+      S2Point mid = proj_.Unproject(pmid);
+      stack.back().first = pb_cur;
+      stack.emplace_back(pmid, mid);
+    }
+  }
+}
+
+void S2EdgeTessellator::AppendProjected(absl::Span<const S2Point> chain,
+                                        vector<R2Point>* vertices) const {
+  if (chain.size() < 2) return;
+  vertices->reserve(vertices->size() + chain.size());
+  // Each vertex is projected only once, and its projection is reused as the
+  // starting point of the following edge.
+  R2Point pa = proj_.Project(chain[0]);
+  if (vertices->empty()) {
+    vertices->push_back(pa);
   } else {
-    R2Point pmid = proj_.Interpolate(0.5, pa, pb);
-    S2Point mid = proj_.Unproject(pmid);
-    AppendUnprojected(pa, a, pmid, mid, vertices);
-    AppendUnprojected(pmid, mid, pb, b, vertices);
+    pa = proj_.WrapDestination(vertices->back(), pa);
+    S2_DCHECK_EQ(vertices->back(), pa) << "Appended edges must form a chain";
   }
+  for (int i = 1; i < chain.size(); ++i) {
+    AppendProjected(pa, chain[i - 1], proj_.Project(chain[i]), chain[i],
+                    vertices);
+    pa = vertices->back();
+  }
+}
+
+void S2EdgeTessellator::AppendUnprojected(absl::Span<const R2Point> chain,
+                                          vector<S2Point>* vertices) const {
+  if (chain.size() < 2) return;
+  vertices->reserve(vertices->size() + chain.size());
+  S2Point a = proj_.Unproject(chain[0]);
+  if (vertices->empty()) {
+    vertices->push_back(a);
+  } else {
+    S2_DCHECK(S2::ApproxEquals(vertices->back(), a))
+        << "Appended edges must form a chain";
+  }
+  for (int i = 1; i < chain.size(); ++i) {
+    S2Point b = proj_.Unproject(chain[i]);
+    AppendUnprojected(chain[i - 1], a, chain[i], b, vertices);
+    a = b;
+  }
+}
+
+void S2EdgeTessellator::ProjectChains(const vector<vector<S2Point>>& chains,
+                                      vector<vector<R2Point>>* output,
+                                      int num_threads) const {
+  output->clear();
+  output->resize(chains.size());
+  S2::internal::ParallelFor(chains.size(), num_threads, [&](int, int i) {
+      AppendProjected(chains[i], &(*output)[i]);
+    });
+}
+
+void S2EdgeTessellator::UnprojectChains(const vector<vector<R2Point>>& chains,
+                                        vector<vector<S2Point>>* output,
+                                        int num_threads) const {
+  output->clear();
+  output->resize(chains.size());
+  S2::internal::ParallelFor(chains.size(), num_threads, [&](int, int i) {
+      AppendUnprojected(chains[i], &(*output)[i]);
+    });
 }
@@ -19,6 +19,7 @@
 #define S2_S2EDGE_TESSELLATOR_H_
 
 #include <vector>
+#include "s2/third_party/absl/types/span.h"
 #include "s2/r2.h"
 #include "s2/s1chord_angle.h"
 #include "s2/s2point.h"
@@ -75,6 +76,36 @@ class S2EdgeTessellator {
   void AppendUnprojected(const R2Point& a, const R2Point& b,
                          std::vector<S2Point>* vertices) const;
 
+  // Converts a chain of spherical geodesic edges (e.g., the vertices of a
+  // polyline) to a chain of planar edges and appends the vertices to
+  // "vertices".  This is equivalent to calling AppendProjected() for each
+  // edge of the chain but is somewhat faster.  A loop can be converted by
+  // repeating its first vertex at the end of the chain.  Nothing is appended
+  // if the chain has fewer than two vertices.
+  void AppendProjected(absl::Span<const S2Point> chain,
+                       std::vector<R2Point>* vertices) const;
+
+  // Converts a chain of planar edges in the given projection to a chain of
+  // spherical geodesic edges and appends the vertices to "vertices".  This is
+  // equivalent to calling AppendUnprojected() for each edge of the chain.
+  void AppendUnprojected(absl::Span<const R2Point> chain,
+                         std::vector<S2Point>* vertices) const;
+
+  // Converts each of the given chains of geodesic edges to a chain of planar
+  // edges, such that (*output)[i] is the result of AppendProjected(chains[i])
+  // applied to an empty vector.  The chains are divided among "num_threads"
+  // threads (if zero, std::thread::hardware_concurrency() is used).  This is
+  // useful when tessellating large datasets (e.g., for rendering).
+  void ProjectChains(const std::vector<std::vector<S2Point>>& chains,
+                     std::vector<std::vector<R2Point>>* output,
+                     int num_threads = 1) const;
+
+  // Like ProjectChains(), but converts chains of planar edges to chains of
+  // geodesic edges as if by AppendUnprojected().
+  void UnprojectChains(const std::vector<std::vector<R2Point>>& chains,
+                       std::vector<std::vector<S2Point>>* output,
+                       int num_threads = 1) const;
+
   // Returns the minimum supported tolerance (which corresponds to a distance
   // less than one micrometer on the Earth's surface).
   static S1Angle kMinTolerance();
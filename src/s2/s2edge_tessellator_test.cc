@@ -253,6 +253,69 @@ TEST(S2EdgeTessellator, ProjectedWrappingMultipleCrossings) {
   EXPECT_EQ(640, max_lng);
 }
 
+TEST(S2EdgeTessellator, ChainsMatchSingleEdges) {
+  // Tessellating a chain in one call must give exactly the same result as
+  // tessellating its edges one at a time.
+  auto loop = ParsePointsOrDie("0:160, 0:-40, 0:120, 0:-80, 10:120, "
+                               "10:-40, 0:160");
+  S2::PlateCarreeProjection proj(180);
+  S2EdgeTessellator tess(&proj, S1Angle::E7(1));
+  vector<R2Point> expected_projected;
+  for (int i = 0; i + 1 < loop.size(); ++i) {
+    tess.AppendProjected(loop[i], loop[i + 1], &expected_projected);
+  }
+  vector<R2Point> projected;
+  tess.AppendProjected(loop, &projected);
+  EXPECT_EQ(expected_projected, projected);
+
+  vector<S2Point> expected_unprojected;
+  for (int i = 0; i + 1 < projected.size(); ++i) {
+    tess.AppendUnprojected(projected[i], projected[i + 1],
+                           &expected_unprojected);
+  }
+  vector<S2Point> unprojected;
+  tess.AppendUnprojected(projected, &unprojected);
+  EXPECT_EQ(expected_unprojected, unprojected);
+
+  // Chains with fewer than two vertices produce no output.
+  vector<R2Point> empty;
+  tess.AppendProjected(vector<S2Point>{loop[0]}, &empty);
+  EXPECT_TRUE(empty.empty());
+}
+
+TEST(S2EdgeTessellator, ProjectAndUnprojectChains) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2::MercatorProjection proj(180);
+  S2EdgeTessellator tess(&proj, S1Angle::Degrees(0.01));
+  vector<vector<S2Point>> chains(300);
+  for (auto& chain : chains) {
+    int num_vertices = S2Testing::rnd.Uniform(6);
+    for (int i = 0; i < num_vertices; ++i) {
+      chain.push_back(S2LatLng::FromDegrees(
+          S2Testing::rnd.UniformDouble(-80, 80),
+          S2Testing::rnd.UniformDouble(-180, 180)).ToPoint());
+    }
+  }
+  for (int num_threads : {1, 3}) {
+    vector<vector<R2Point>> projected;
+    tess.ProjectChains(chains, &projected, num_threads);
+    ASSERT_EQ(chains.size(), projected.size());
+    for (int i = 0; i < chains.size(); ++i) {
+      vector<R2Point> expected;
+      tess.AppendProjected(chains[i], &expected);
+      EXPECT_EQ(expected, projected[i]);
+    }
+    vector<vector<S2Point>> unprojected;
+    tess.UnprojectChains(projected, &unprojected, num_threads);
+    ASSERT_EQ(projected.size(), unprojected.size());
+    for (int i = 0; i < projected.size(); ++i) {
+      vector<S2Point> expected;
+      tess.AppendUnprojected(projected[i], &expected);
+      EXPECT_EQ(expected, unprojected[i]);
+    }
+  }
+}
+
 TEST(S2EdgeTessellator, InfiniteRecursionBug) {
   S2::PlateCarreeProjection proj(180);
   S1Angle kOneMicron = S1Angle::Radians(1e-6 / 6371.0);
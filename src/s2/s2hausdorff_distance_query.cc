@@ -0,0 +1,304 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2hausdorff_distance_query.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <vector>
+
+#include "s2/s2cap.h"
+#include "s2/s2cell.h"
+#include "s2/s2cell_id.h"
+#include "s2/s2closest_edge_query.h"
+#include "s2/s2shape.h"
+
+using std::max;
+
+S2HausdorffDistanceQuery::Options::Options()
+    : max_error_(S1Angle::Radians(1e-9)) {
+}
+
+bool S2HausdorffDistanceQuery::Options::include_interiors() const {
+  return include_interiors_;
+}
+
+void S2HausdorffDistanceQuery::Options::set_include_interiors(
+    bool include_interiors) {
+  include_interiors_ = include_interiors;
+}
+
+S1Angle S2HausdorffDistanceQuery::Options::max_error() const {
+  return max_error_;
+}
+
+void S2HausdorffDistanceQuery::Options::set_max_error(S1Angle max_error) {
+  max_error_ = max_error;
+}
+
+S2HausdorffDistanceQuery::S2HausdorffDistanceQuery(const Options& options)
+    : options_(options) {
+}
+
+namespace {
+
+// The distance from a target point to the source geometry, together with
+// the closest source edge and the closest point on that edge.
+struct Sample {
+  S2Point point;
+  S1ChordAngle distance;
+  double radians;  // distance.ToAngle().radians(), cached.
+  S2ClosestEdgeQuery::Result result;
+  S2Point closest;  // Defined only if result.edge_id() >= 0.
+};
+
+// A piece of a target edge, represented by the samples at its endpoints,
+// together with an upper bound (in radians) on the distance from any of its
+// points to the source geometry.
+struct Piece {
+  Sample a, b;
+  double upper_bound;
+
+  // Sorts pieces so that the largest upper bound is at the top of a
+  // std::priority_queue.
+  bool operator<(const Piece& other) const {
+    return upper_bound < other.upper_bound;
+  }
+};
+
+// A cell that intersects the target index, together with an upper bound (in
+// radians) on the distance from any of its points to the source geometry.
+struct CellCandidate {
+  S2CellId id;
+  S2Point center;          // The center of the cell's bounding cap.
+  double center_distance;  // Distance from "center" in radians, or -1.
+  double upper_bound;
+
+  bool operator<(const CellCandidate& other) const {
+    return upper_bound < other.upper_bound;
+  }
+};
+
+}  // namespace
+
+// Returns the piece between samples "a" and "b" with an upper bound on the
+// distance from its points to the source geometry.  Distances change by at
+// most the distance moved, and every point of the piece is within L/2 of
+// one of its endpoints (where L is the length of the piece), so one bound is
+// (da + db + L) / 2.  This bound converges slowly when the distance is
+// nearly constant, however, so we also use the following bound.
+//
+// Suppose that the closest source points "qa" and "qb" to the endpoints lie
+// on the same source edge, so that the geodesic QA = [qa, qb] is part of the
+// source geometry.  Every point of the piece is the normalization of
+// P = (1-t) a + t b for some t in [0, 1]; let Q = (1-t) qa + t qb.  Then
+// |P - Q| <= max(|a - qa|, |b - qb|), and |P|, |Q| >= cos(M/2) where M is the
+// larger of the lengths of the piece and QA.  By the Dunkl-Williams
+// inequality, |P/|P| - Q/|Q|| <= 2 |P - Q| / (|P| + |Q|), and therefore the
+// chord distance from any point of the piece to QA is at most
+// max(|a - qa|, |b - qb|) / cos(M/2).  Since this bound exceeds max(da, db)
+// only by a term proportional to M^2, nearly parallel pieces are discarded
+// after very few subdivisions.
+static Piece MakePiece(const Sample& a, const Sample& b) {
+  double length = a.point.Angle(b.point);
+  double bound = 0.5 * (a.radians + b.radians + length);
+  const S2ClosestEdgeQuery::Result& ra = a.result;
+  const S2ClosestEdgeQuery::Result& rb = b.result;
+  if (ra.edge_id() >= 0 && ra.shape_id() == rb.shape_id() &&
+      ra.edge_id() == rb.edge_id()) {
+    double m = std::max(length, a.closest.Angle(b.closest));
+    double chord = std::max(a.distance.length2(), b.distance.length2());
+    chord = sqrt(chord) / cos(0.5 * m);
+    if (chord < 2) bound = std::min(bound, 2 * asin(0.5 * chord));
+  }
+  return Piece{a, b, bound};
+}
+
+S2HausdorffDistanceQuery::DirectedResult
+S2HausdorffDistanceQuery::GetDirectedResult(
+    const S2ShapeIndex& target, const S2ShapeIndex& source) const {
+  S2ClosestEdgeQuery::Options query_options;
+  query_options.set_include_interiors(options_.include_interiors());
+  S2ClosestEdgeQuery query(&source, query_options);
+  auto get_sample = [&query](const S2Point& p) {
+    S2ClosestEdgeQuery::PointTarget point_target(p);
+    Sample sample;
+    sample.point = p;
+    sample.result = query.FindClosestEdge(&point_target);
+    sample.distance = sample.result.distance();
+    sample.radians = sample.distance.ToAngle().radians();
+    if (sample.result.edge_id() >= 0) {
+      sample.closest = query.Project(p, sample.result);
+    }
+    return sample;
+  };
+  // Pieces whose endpoints are both inside source polygons are entirely
+  // inside if they do not come within any positive distance of a source edge
+  // (i.e., they do not cross the source boundary).
+  S2ClosestEdgeQuery boundary_query(&source);
+  boundary_query.mutable_options()->set_include_interiors(false);
+  auto is_interior = [&boundary_query](const Piece& piece) {
+    if (piece.a.result.edge_id() >= 0 || piece.b.result.edge_id() >= 0) {
+      return false;
+    }
+    S2ClosestEdgeQuery::EdgeTarget edge_target(piece.a.point, piece.b.point);
+    return !boundary_query.IsDistanceLessOrEqual(&edge_target,
+                                                 S1ChordAngle::Zero());
+  };
+
+  DirectedResult result;
+  double best = -1;  // result.distance in radians.
+  auto update_best = [&result, &best](const Sample& sample) {
+    if (sample.distance > result.distance) {
+      result.distance = sample.distance;
+      result.target_point = sample.point;
+      best = sample.radians;
+    }
+  };
+
+  // If the source geometry is empty then every distance is infinite, and
+  // any target vertex can be returned.
+  for (S2Shape* shape : target) {
+    if (shape == nullptr || shape->num_edges() == 0) continue;
+    Sample sample = get_sample(shape->edge(0).v0);
+    if (sample.distance == S1ChordAngle::Infinity()) {
+      update_best(sample);
+      return result;
+    }
+    break;
+  }
+
+  // The search is best-first over two kinds of candidates, each with an
+  // upper bound on the distance from its points to the source geometry:
+  //
+  //  - S2CellIds that intersect the target index.  Since every point of a
+  //    cell is within the cell's bounding cap, the distance from the cap
+  //    center plus the cap radius is an upper bound.  This allows entire
+  //    regions of the target geometry to be skipped without measuring the
+  //    distance at any of their vertices.
+  //
+  //  - Pieces of target edges (see MakePiece).  The edges of an index cell
+  //    are added once the cell itself can no longer be discarded.
+  //
+  // The candidate with the largest upper bound is processed next, and the
+  // search stops once no candidate can improve the result by more than
+  // max_error().
+  const double max_error = options_.max_error().radians();
+  std::priority_queue<CellCandidate> cells;
+  std::priority_queue<Piece> pieces;
+  S2ShapeIndex::Iterator iter(&target, S2ShapeIndex::UNPOSITIONED);
+
+  // Measuring the distance from the center of a cell costs as much as
+  // measuring it at a vertex.  This is worthwhile for cells that contain
+  // several index cells, but the edges of an index cell are sampled anyway
+  // unless the cell is discarded, so index cells instead use a weaker bound
+  // derived from the center of their parent.
+  auto maybe_enqueue_cell = [&](S2CellId id, const CellCandidate* parent) {
+    S2ShapeIndex::CellRelation relation = iter.Locate(id);
+    if (relation == S2ShapeIndex::DISJOINT) return;
+    S2Cap cap = S2Cell(id).GetCapBound();
+    double radius = cap.GetRadius().radians();
+    CellCandidate candidate{id, cap.center(), -1, 0};
+    if (relation == S2ShapeIndex::SUBDIVIDED || parent == nullptr) {
+      candidate.center_distance = get_sample(cap.center()).radians;
+      candidate.upper_bound = candidate.center_distance + radius;
+    } else {
+      candidate.upper_bound = std::min(
+          parent->upper_bound, parent->center_distance +
+          parent->center.Angle(cap.center()) + radius);
+    }
+    if (candidate.upper_bound > best + max_error) cells.push(candidate);
+  };
+  auto maybe_enqueue_piece = [&](const Piece& piece) {
+    if (piece.upper_bound > best + max_error && !is_interior(piece)) {
+      pieces.push(piece);
+    }
+  };
+  // Edges that span several index cells are sampled only once.
+  std::vector<std::vector<bool>> visited_edges(target.num_shape_ids());
+  auto process_cell = [&](const CellCandidate& candidate) {
+    S2CellId id = candidate.id;
+    S2ShapeIndex::CellRelation relation = iter.Locate(id);
+    if (relation == S2ShapeIndex::SUBDIVIDED) {
+      for (S2CellId child = id.child_begin(); child != id.child_end();
+           child = child.next()) {
+        maybe_enqueue_cell(child, &candidate);
+      }
+      return;
+    }
+    if (relation != S2ShapeIndex::INDEXED) return;
+    // Consecutive edges within a cell usually share a vertex, in which case
+    // the sample from the end of the previous edge is reused.
+    const S2ShapeIndexCell& cell = iter.cell();
+    Sample a, b;
+    bool has_b = false;
+    for (int s = 0; s < cell.num_clipped(); ++s) {
+      const S2ClippedShape& clipped = cell.clipped(s);
+      const S2Shape& shape = *target.shape(clipped.shape_id());
+      std::vector<bool>* visited = &visited_edges[clipped.shape_id()];
+      if (visited->empty()) visited->resize(shape.num_edges());
+      for (int j = 0; j < clipped.num_edges(); ++j) {
+        int e = clipped.edge(j);
+        if ((*visited)[e]) continue;
+        (*visited)[e] = true;
+        S2Shape::Edge edge = shape.edge(e);
+        if (!has_b || b.point != edge.v0) {
+          a = get_sample(edge.v0);
+          update_best(a);
+        } else {
+          a = b;
+        }
+        if (edge.v0 == edge.v1) continue;
+        b = get_sample(edge.v1);
+        has_b = true;
+        update_best(b);
+        maybe_enqueue_piece(MakePiece(a, b));
+      }
+    }
+  };
+  for (int face = 0; face < 6; ++face) {
+    maybe_enqueue_cell(S2CellId::FromFace(face), nullptr);
+  }
+  for (;;) {
+    double cell_bound = cells.empty() ? -1 : cells.top().upper_bound;
+    double piece_bound = pieces.empty() ? -1 : pieces.top().upper_bound;
+    if (std::max(cell_bound, piece_bound) <= best + max_error) break;
+    if (cell_bound >= piece_bound) {
+      CellCandidate candidate = cells.top();
+      cells.pop();
+      process_cell(candidate);
+    } else {
+      // Split the piece with the largest upper bound in half.
+      Piece piece = pieces.top();
+      pieces.pop();
+      Sample mid = get_sample((piece.a.point + piece.b.point).Normalize());
+      update_best(mid);
+      maybe_enqueue_piece(MakePiece(piece.a, mid));
+      maybe_enqueue_piece(MakePiece(mid, piece.b));
+    }
+  }
+  return result;
+}
+
+S1ChordAngle S2HausdorffDistanceQuery::GetDirectedDistance(
+    const S2ShapeIndex& target, const S2ShapeIndex& source) const {
+  return GetDirectedResult(target, source).distance;
+}
+
+S1ChordAngle S2HausdorffDistanceQuery::GetDistance(
+    const S2ShapeIndex& a, const S2ShapeIndex& b) const {
+  return max(GetDirectedDistance(a, b), GetDirectedDistance(b, a));
+}
@@ -0,0 +1,125 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef S2_S2HAUSDORFF_DISTANCE_QUERY_H_
+#define S2_S2HAUSDORFF_DISTANCE_QUERY_H_
+
+#include "s2/s1angle.h"
+#include "s2/s1chord_angle.h"
+#include "s2/s2point.h"
+#include "s2/s2shape_index.h"
+
+// S2HausdorffDistanceQuery computes the Hausdorff distance between the
+// geometry in two S2ShapeIndexes.  The directed Hausdorff distance from
+// geometry T (the "target") to geometry S (the "source") is the maximum,
+// over all points p of T, of the distance from p to S.  The undirected
+// Hausdorff distance is the maximum of the two directed distances.  This is
+// a natural way to measure how well two geometries match (e.g., comparing a
+// reconstructed road against its reference geometry).
+//
+// The points of T considered are all points on its edges, including the
+// interior points of each edge (not just its vertices).  Polygon interiors of
+// T are not considered.  Distances to S are measured with S2ClosestEdgeQuery,
+// so they include the interiors of polygons in S unless include_interiors()
+// is false.
+//
+// The maximum is found by a best-first branch-and-bound search.  The search
+// starts with the S2CellIds that intersect the index of T, bounding the
+// distance from each cell to S by the distance from its center plus its
+// radius, and descends only into cells that might improve the result by more
+// than max_error().  The edges of the remaining index cells are then
+// repeatedly split in half, and each piece is discarded as soon as an upper
+// bound on its distance to S shows that it cannot improve the result by more
+// than max_error().  The bounds used for pieces are tight for pieces whose
+// endpoints are closest to the same edge of S (e.g., nearly parallel
+// polylines) or that lie entirely inside a polygon of S, so few subdivisions
+// are needed except near the points where the maximum is achieved.
+//
+// The result is always achieved by an actual point of T, and is within
+// max_error() of the true Hausdorff distance.  (The distance to S along an
+// edge of T is not a simple function, so the search cannot stop at an exact
+// maximum; max_error() may be made as small as desired, but the cost grows
+// as it decreases.)
+//
+// Example usage:
+//
+//   S2HausdorffDistanceQuery query;
+//   S1ChordAngle distance = query.GetDistance(road_index, reference_index);
+//
+// This class is not thread-safe, but a single query object may be used to
+// compute any number of distances.
+class S2HausdorffDistanceQuery {
+ public:
+  class Options {
+   public:
+    Options();
+
+    // If true, polygon interiors of the source geometry are included when
+    // measuring distances to it, so that points of the target geometry
+    // inside source polygons have distance zero.
+    //
+    // DEFAULT: true
+    bool include_interiors() const;
+    void set_include_interiors(bool include_interiors);
+
+    // The maximum amount by which the computed distance may be smaller than
+    // the true Hausdorff distance.  Smaller values are more expensive.
+    //
+    // DEFAULT: 1e-9 radians (about 6 millimeters on the Earth's surface)
+    S1Angle max_error() const;
+    void set_max_error(S1Angle max_error);
+
+   private:
+    bool include_interiors_ = true;
+    S1Angle max_error_;
+  };
+
+  // The result of a directed distance computation.
+  struct DirectedResult {
+    // The directed Hausdorff distance.  This is S1ChordAngle::Negative() if
+    // the target geometry has no edges, and S1ChordAngle::Infinity() if the
+    // source geometry is empty (and the target is not).
+    S1ChordAngle distance = S1ChordAngle::Negative();
+
+    // A point of the target geometry whose distance to the source geometry
+    // is "distance".  Undefined if distance is negative.
+    S2Point target_point;
+  };
+
+  explicit S2HausdorffDistanceQuery(const Options& options = Options());
+
+  const Options& options() const { return options_; }
+  Options* mutable_options() { return &options_; }
+
+  // Returns the directed Hausdorff distance from "target" to "source", and a
+  // point of "target" where it is achieved.
+  DirectedResult GetDirectedResult(const S2ShapeIndex& target,
+                                   const S2ShapeIndex& source) const;
+
+  // Convenience method that returns only the directed distance.
+  S1ChordAngle GetDirectedDistance(const S2ShapeIndex& target,
+                                   const S2ShapeIndex& source) const;
+
+  // Returns the undirected Hausdorff distance between "a" and "b", i.e. the
+  // maximum of the directed distances in both directions.  Returns
+  // S1ChordAngle::Negative() if both geometries are empty.
+  S1ChordAngle GetDistance(const S2ShapeIndex& a,
+                           const S2ShapeIndex& b) const;
+
+ private:
+  Options options_;
+};
+
+#endif  // S2_S2HAUSDORFF_DISTANCE_QUERY_H_
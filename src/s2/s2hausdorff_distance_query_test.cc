@@ -0,0 +1,174 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2hausdorff_distance_query.h"
+
+#include <algorithm>
+#include <memory>
+
+#include <gtest/gtest.h>
+#include "s2/third_party/absl/memory/memory.h"
+#include "s2/mutable_s2shape_index.h"
+#include "s2/s1angle.h"
+#include "s2/s2cap.h"
+#include "s2/s2closest_edge_query.h"
+#include "s2/s2edge_distances.h"
+#include "s2/s2loop.h"
+#include "s2/s2polyline.h"
+#include "s2/s2testing.h"
+#include "s2/s2text_format.h"
+
+using absl::make_unique;
+using s2textformat::MakeIndexOrDie;
+using std::vector;
+
+namespace {
+
+// Returns the maximum distance from "num_samples" + 1 evenly spaced points
+// along each edge of "target" to "source".
+S1Angle GetSampledDirectedDistance(const S2ShapeIndex& target,
+                                   const S2ShapeIndex& source,
+                                   int num_samples) {
+  S2ClosestEdgeQuery query(&source);
+  S1Angle result = S1Angle::Radians(-1);
+  for (S2Shape* shape : target) {
+    for (int e = 0; e < shape->num_edges(); ++e) {
+      S2Shape::Edge edge = shape->edge(e);
+      for (int i = 0; i <= num_samples; ++i) {
+        S2Point p = S2::Interpolate(static_cast<double>(i) / num_samples,
+                                    edge.v0, edge.v1);
+        S2ClosestEdgeQuery::PointTarget point_target(p);
+        result = std::max(result, query.GetDistance(&point_target).ToAngle());
+      }
+    }
+  }
+  return result;
+}
+
+// Checks that the directed distance computed by S2HausdorffDistanceQuery is
+// consistent with the distance obtained by sampling points along each edge.
+void CheckDirectedDistance(const S2ShapeIndex& target,
+                           const S2ShapeIndex& source,
+                           S1Angle max_edge_length) {
+  const int kNumSamples = 100;
+  S2HausdorffDistanceQuery query;
+  auto result = query.GetDirectedResult(target, source);
+  S1Angle actual = result.distance.ToAngle();
+  S1Angle sampled = GetSampledDirectedDistance(target, source, kNumSamples);
+  // The result is achieved by a point of "target", so it cannot exceed the
+  // true distance, which is at most the sampled distance plus half the
+  // sample spacing.
+  EXPECT_LE(actual, sampled + 0.5 * max_edge_length / kNumSamples);
+  EXPECT_GE(actual, sampled - query.options().max_error());
+
+  // Check that "target_point" achieves the reported distance.
+  S2ClosestEdgeQuery source_query(&source);
+  S2ClosestEdgeQuery::PointTarget point_target(result.target_point);
+  EXPECT_EQ(result.distance, source_query.GetDistance(&point_target));
+}
+
+TEST(S2HausdorffDistanceQuery, MaximumInsideEdge) {
+  // The distance from the edge to the two points is maximized halfway along
+  // the edge, even though it is zero at both vertices.
+  auto target = MakeIndexOrDie("# 0:0, 0:10 #");
+  auto source = MakeIndexOrDie("0:0 | 0:10 # #");
+  S2HausdorffDistanceQuery query;
+  auto result = query.GetDirectedResult(*target, *source);
+  EXPECT_NEAR(5, result.distance.degrees(), 1e-7);
+  EXPECT_TRUE(S2::ApproxEquals(S2LatLng::FromDegrees(0, 5).ToPoint(),
+                               result.target_point, S1Angle::Degrees(1e-6)));
+  // In the other direction, every point of "source" is on "target".
+  EXPECT_EQ(S1ChordAngle::Zero(),
+            query.GetDirectedDistance(*source, *target));
+  EXPECT_EQ(result.distance, query.GetDistance(*source, *target));
+}
+
+TEST(S2HausdorffDistanceQuery, IncludeInteriors) {
+  auto polygon = MakeIndexOrDie("# # 0:0, 0:10, 10:10, 10:0");
+  auto polyline = MakeIndexOrDie("# 3:3, 4:6 #");  // Closest edge is 4 away.
+  S2HausdorffDistanceQuery query;
+  EXPECT_EQ(S1ChordAngle::Zero(),
+            query.GetDirectedDistance(*polyline, *polygon));
+  query.mutable_options()->set_include_interiors(false);
+  EXPECT_NEAR(4, query.GetDirectedDistance(*polyline, *polygon).degrees(),
+              0.05);
+}
+
+TEST(S2HausdorffDistanceQuery, EmptyGeometry) {
+  MutableS2ShapeIndex empty;
+  auto index = MakeIndexOrDie("0:0 # 1:1, 2:2 #");
+  S2HausdorffDistanceQuery query;
+  EXPECT_EQ(S1ChordAngle::Negative(), query.GetDirectedDistance(empty, *index));
+  EXPECT_EQ(S1ChordAngle::Infinity(), query.GetDirectedDistance(*index, empty));
+  EXPECT_EQ(S1ChordAngle::Infinity(), query.GetDistance(empty, *index));
+  EXPECT_EQ(S1ChordAngle::Negative(), query.GetDistance(empty, empty));
+}
+
+TEST(S2HausdorffDistanceQuery, PolylinesMatchSampling) {
+  auto a = MakeIndexOrDie("# 0:0, 0:10, 2:20, -1:30 #");
+  auto b = MakeIndexOrDie("# 1:0, 1:12, -1:18, 0:31 | 5:15 #");
+  CheckDirectedDistance(*a, *b, S1Angle::Degrees(11));
+  CheckDirectedDistance(*b, *a, S1Angle::Degrees(12));
+}
+
+TEST(S2HausdorffDistanceQuery, ParallelPolylines) {
+  // The distance is nearly constant along these long edges, which requires
+  // very many subdivisions unless the search uses a tight upper bound.
+  auto a = MakeIndexOrDie("# 0:0, 0:40, 0:80 #");
+  auto b = MakeIndexOrDie("# 0.001:0, 0.001:40, 0.001:80 #");
+  CheckDirectedDistance(*a, *b, S1Angle::Degrees(40));
+  CheckDirectedDistance(*b, *a, S1Angle::Degrees(40));
+}
+
+TEST(S2HausdorffDistanceQuery, FractalsMatchSampling) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(100);
+  fractal.set_fractal_dimension(1.3);
+  for (int iter = 0; iter < 3; ++iter) {
+    S2Point center = S2Testing::RandomPoint();
+    MutableS2ShapeIndex a, b;
+    a.Add(make_unique<S2Loop::OwningShape>(fractal.MakeLoop(
+        S2Testing::GetRandomFrameAt(center), S1Angle::Degrees(5))));
+    b.Add(make_unique<S2Loop::OwningShape>(fractal.MakeLoop(
+        S2Testing::GetRandomFrameAt(center), S1Angle::Degrees(5))));
+    CheckDirectedDistance(a, b, S1Angle::Degrees(2));
+    CheckDirectedDistance(b, a, S1Angle::Degrees(2));
+  }
+}
+
+TEST(S2HausdorffDistanceQuery, SingleDistantVertex) {
+  // The target geometry has many index cells, almost all of which can be
+  // discarded once the distant vertex has been found.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(1000);
+  auto loop = fractal.MakeLoop(S2Testing::GetRandomFrame(),
+                               S1Angle::Degrees(5));
+  vector<S2Point> vertices(&loop->vertex(0),
+                           &loop->vertex(0) + loop->num_vertices());
+  MutableS2ShapeIndex source;
+  source.Add(make_unique<S2Polyline::OwningShape>(
+      make_unique<S2Polyline>(vertices)));
+  S2Point* moved = &vertices[vertices.size() / 2];
+  *moved = (*moved + 0.01 * S2Testing::RandomPoint()).Normalize();
+  MutableS2ShapeIndex target;
+  target.Add(make_unique<S2Polyline::OwningShape>(
+      make_unique<S2Polyline>(vertices)));
+  CheckDirectedDistance(target, source, S1Angle::Degrees(1));
+  CheckDirectedDistance(source, target, S1Angle::Degrees(1));
+}
+
+}  // namespace
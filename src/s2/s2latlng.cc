@@ -25,6 +25,7 @@
 
 using std::max;
 using std::min;
+using std::vector;
 
 S2LatLng S2LatLng::Normalized() const {
   // remainder(x, 2 * M_PI) reduces its argument to the range [-M_PI, M_PI]
@@ -49,6 +50,20 @@ S2LatLng::S2LatLng(const S2Point& p)
       << "Invalid S2LatLng in constructor: " << *this;
 }
 
+void S2LatLng::ToPoints(absl::Span<const S2LatLng> latlngs,
+                        vector<S2Point>* points) {
+  points->clear();
+  points->reserve(latlngs.size());
+  for (const S2LatLng& latlng : latlngs) points->push_back(latlng.ToPoint());
+}
+
+void S2LatLng::FromPoints(absl::Span<const S2Point> points,
+                          vector<S2LatLng>* latlngs) {
+  latlngs->clear();
+  latlngs->reserve(points.size());
+  for (const S2Point& p : points) latlngs->push_back(S2LatLng(p));
+}
+
 S1Angle S2LatLng::GetDistance(const S2LatLng& o) const {
   // This implements the Haversine formula, which is numerically stable for
   // small distances but only gets about 8 digits of precision for very large
@@ -22,11 +22,13 @@
 #include <iosfwd>
 #include <ostream>
 #include <string>
+#include <vector>
 
 #include "s2/base/integral_types.h"
 #include "s2/_fp_contract_off.h"
 #include "s2/r2.h"
 #include "s2/s1angle.h"
+#include "s2/third_party/absl/types/span.h"
 #include "s2/util/math/vector.h"
 
 // This class represents a point on the unit sphere as a pair
@@ -98,6 +100,18 @@ class S2LatLng {
   // Converts to an S2Point (equivalent to the operator above).
   S2Point ToPoint() const;
 
+  // Convenience method that converts each of the given S2LatLngs to an
+  // S2Point using ToPoint() and stores the results in "points" (which is
+  // resized as necessary).
+  static void ToPoints(absl::Span<const S2LatLng> latlngs,
+                       std::vector<S2Point>* points);
+
+  // Convenience method that converts each of the given points to an
+  // S2LatLng using the S2LatLng(S2Point) constructor and stores the results
+  // in "latlngs" (which is resized as necessary).
+  static void FromPoints(absl::Span<const S2Point> points,
+                         std::vector<S2LatLng>* latlngs);
+
   // Returns the distance (measured along the surface of the sphere) to the
   // given S2LatLng, implemented using the Haversine formula.  This is
   // equivalent to
@@ -20,6 +20,7 @@
 #include <cmath>
 #include <cstdio>
 #include <unordered_map>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -97,6 +98,29 @@ TEST(S2LatLng, TestConversion) {
   }
 }
 
+TEST(S2LatLng, TestBulkConversion) {
+  std::vector<S2Point> points;
+  for (int i = 0; i < 1000; ++i) {
+    points.push_back(S2Testing::RandomPoint());
+  }
+  points.push_back(S2Point(0, 0, 1));
+  points.push_back(S2Point(-1, 0, 0));
+  std::vector<S2LatLng> latlngs;
+  S2LatLng::FromPoints(points, &latlngs);
+  ASSERT_EQ(points.size(), latlngs.size());
+  for (int i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(S2LatLng(points[i]), latlngs[i]);
+  }
+  std::vector<S2Point> result;
+  S2LatLng::ToPoints(latlngs, &result);
+  ASSERT_EQ(latlngs.size(), result.size());
+  for (int i = 0; i < latlngs.size(); ++i) {
+    EXPECT_EQ(latlngs[i].ToPoint(), result[i]);
+  }
+  S2LatLng::ToPoints({}, &result);
+  EXPECT_TRUE(result.empty());
+}
+
 TEST(S2LatLng, TestDistance) {
   EXPECT_EQ(0.0,
             S2LatLng::FromDegrees(90, 0).GetDistance(
@@ -54,6 +54,15 @@ bool S2MaxDistancePointTarget::UpdateMinDistance(
   return min_dist->UpdateMin(S2MaxDistance(cell.GetMaxDistance(point_)));
 }
 
+void S2MaxDistancePointTarget::UpdateChildMinDistances(
+    const S2Cell& parent, S2MaxDistance min_dists[4]) {
+  S1ChordAngle distances[4];
+  parent.GetChildMaxDistances(point_, distances);
+  for (int i = 0; i < 4; ++i) {
+    min_dists[i].UpdateMin(S2MaxDistance(distances[i]));
+  }
+}
+
 bool S2MaxDistancePointTarget::VisitContainingShapes(
     const S2ShapeIndex& index, const ShapeVisitor& visitor) {
   // For furthest points, we visit the polygons whose interior contains the
@@ -85,6 +85,8 @@ class S2MaxDistancePointTarget : public S2MaxDistanceTarget {
                          S2MaxDistance* min_dist) final;
   bool UpdateMinDistance(const S2Cell& cell,
                          S2MaxDistance* min_dist) final;
+  void UpdateChildMinDistances(const S2Cell& parent,
+                               S2MaxDistance min_dists[4]) final;
   bool VisitContainingShapes(const S2ShapeIndex& index,
                              const ShapeVisitor& visitor) final;
 
@@ -37,6 +37,18 @@ using s2textformat::MakePointOrDie;
 using s2textformat::ParsePointsOrDie;
 using std::vector;
 
+TEST(S2MaxDistance, GetDistanceLimit) {
+  // For maximum distances, a result must be further by a factor of
+  // (1 + max_relative_error) to replace the current one.
+  S2MaxDistance distance{S1ChordAngle::Radians(1)};
+  auto limit = S2::GetDistanceLimit(distance, S1ChordAngle::Zero(), 0.1);
+  EXPECT_NEAR(1.1, static_cast<S1ChordAngle>(limit).radians(), 1e-14);
+
+  // The larger of the absolute and relative errors is used.
+  limit = S2::GetDistanceLimit(distance, S1ChordAngle::Radians(0.5), 0.1);
+  EXPECT_NEAR(1.5, static_cast<S1ChordAngle>(limit).radians(), 1e-14);
+}
+
 TEST(CellTarget, GetCapBound) {
   for (int i = 0; i < 100; i++) {
     S2Cell cell = S2Cell{S2Testing::GetRandomCellId()};
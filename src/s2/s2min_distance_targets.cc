@@ -46,6 +46,15 @@ bool S2MinDistancePointTarget::UpdateMinDistance(
   return min_dist->UpdateMin(S2MinDistance(cell.GetDistance(point_)));
 }
 
+void S2MinDistancePointTarget::UpdateChildMinDistances(
+    const S2Cell& parent, S2MinDistance min_dists[4]) {
+  S1ChordAngle distances[4];
+  parent.GetChildDistances(point_, distances);
+  for (int i = 0; i < 4; ++i) {
+    min_dists[i].UpdateMin(S2MinDistance(distances[i]));
+  }
+}
+
 bool S2MinDistancePointTarget::VisitContainingShapes(
     const S2ShapeIndex& index, const ShapeVisitor& visitor) {
   return MakeS2ContainsPointQuery(&index).VisitContainingShapes(
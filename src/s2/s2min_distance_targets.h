@@ -79,6 +79,8 @@ class S2MinDistancePointTarget : public S2MinDistanceTarget {
                          S2MinDistance* min_dist) final;
   bool UpdateMinDistance(const S2Cell& cell,
                          S2MinDistance* min_dist) final;
+  void UpdateChildMinDistances(const S2Cell& parent,
+                               S2MinDistance min_dists[4]) final;
   bool VisitContainingShapes(const S2ShapeIndex& index,
                              const ShapeVisitor& visitor) final;
 
@@ -190,6 +192,10 @@ class S2MinDistanceCellUnionTarget : public S2MinDistanceTarget {
 //         ... do something with "target_point" ...
 //         return false;  // Terminate search
 //       }));
+//
+// If you only need the distance between two large S2ShapeIndexes (rather
+// than the closest edges), s2shapeutil::GetMinDistance() is much faster (see
+// s2shapeutil_index_distance.h).
 class S2MinDistanceShapeIndexTarget : public S2MinDistanceTarget {
  public:
   explicit S2MinDistanceShapeIndexTarget(const S2ShapeIndex* index);
@@ -34,6 +34,18 @@ using s2textformat::MakePointOrDie;
 using s2textformat::ParsePointsOrDie;
 using std::vector;
 
+TEST(S2MinDistance, GetDistanceLimit) {
+  // For minimum distances, a result must be closer by a factor of
+  // (1 + max_relative_error) to replace the current one.
+  S2MinDistance distance{S1ChordAngle::Radians(1)};
+  auto limit = S2::GetDistanceLimit(distance, S1ChordAngle::Zero(), 0.1);
+  EXPECT_NEAR(1 / 1.1, static_cast<S1ChordAngle>(limit).radians(), 1e-14);
+
+  // The larger of the absolute and relative errors is used.
+  limit = S2::GetDistanceLimit(distance, S1ChordAngle::Radians(0.5), 0.1);
+  EXPECT_NEAR(0.5, static_cast<S1ChordAngle>(limit).radians(), 1e-14);
+}
+
 TEST(PointTarget, UpdateMinDistanceToEdgeWhenEqual) {
   // Verifies that UpdateMinDistance only returns true when the new distance
   // is less than the old distance (not less than or equal to).
@@ -54,6 +66,34 @@ TEST(PointTarget, UpdateMinDistanceToCellWhenEqual) {
   EXPECT_FALSE(target.UpdateMinDistance(cell, &dist));
 }
 
+// Checks that UpdateChildMinDistances() is equivalent to calling
+// UpdateMinDistance() for each child whose distance is not Zero().
+static void CheckUpdateChildMinDistances(S2MinDistanceTarget* target,
+                                         const S2Cell& parent) {
+  S2Cell children[4];
+  ASSERT_TRUE(parent.Subdivide(children));
+  S2MinDistance limit(S1ChordAngle::Degrees(2));
+  S2MinDistance dists[4] = {limit, S2MinDistance::Zero(), limit, limit};
+  target->UpdateChildMinDistances(parent, dists);
+  for (int i = 0; i < 4; ++i) {
+    S2MinDistance expected = (i == 1) ? S2MinDistance::Zero() : limit;
+    if (i != 1) target->UpdateMinDistance(children[i], &expected);
+    EXPECT_EQ(expected, dists[i]);
+  }
+}
+
+TEST(PointTarget, UpdateChildMinDistances) {
+  S2MinDistancePointTarget target(MakePointOrDie("0.5:0.7"));
+  CheckUpdateChildMinDistances(
+      &target, S2Cell(S2CellId(MakePointOrDie("0:0")).parent(8)));
+}
+
+TEST(EdgeTarget, UpdateChildMinDistances) {
+  S2MinDistanceEdgeTarget target(MakePointOrDie("1:0"), MakePointOrDie("1:1"));
+  CheckUpdateChildMinDistances(
+      &target, S2Cell(S2CellId(MakePointOrDie("0:0")).parent(8)));
+}
+
 TEST(EdgeTarget, UpdateMinDistanceToEdgeWhenEqual) {
   S2MinDistanceEdgeTarget target(MakePointOrDie("1:0"), MakePointOrDie("1:1"));
   S2MinDistance dist(S1ChordAngle::Infinity());
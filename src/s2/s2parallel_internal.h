@@ -0,0 +1,85 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef S2_S2PARALLEL_INTERNAL_H_
+#define S2_S2PARALLEL_INTERNAL_H_
+
+// Helpers for the multi-threaded variants of various S2 operations.  These
+// are not part of the public API.
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "s2/base/integral_types.h"
+
+namespace S2 {
+namespace internal {
+
+// Returns "num_threads" if it is positive, and otherwise the number of
+// hardware threads (which is always at least 1).
+inline int GetNumThreads(int num_threads) {
+  if (num_threads > 0) return num_threads;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Divides the range [0, n) into "num_chunks" contiguous chunks of nearly
+// equal size, where chunk "i" is [n * i / num_chunks, n * (i+1) / num_chunks),
+// and calls
+//
+//   fn(thread, chunk, begin, end)
+//
+// for every chunk (including empty ones).  Chunks are handed out in order to
+// "num_threads" threads as they become available (if zero, the number of
+// hardware threads is used), where "thread" is in the range [0, num_threads)
+// and can be used to index per-thread state.  Thread 0 is the calling
+// thread.  Returns once all chunks have been processed.
+template <class Function>
+void ParallelForChunks(int n, int num_chunks, int num_threads,
+                       const Function& fn) {
+  num_threads = std::max(1, std::min(GetNumThreads(num_threads), num_chunks));
+  std::atomic<int> next_chunk(0);
+  auto worker = [&](int thread) {
+    for (int chunk;
+         (chunk = next_chunk.fetch_add(1, std::memory_order_relaxed)) <
+             num_chunks; ) {
+      fn(thread, chunk, static_cast<int>(static_cast<int64>(n) * chunk /
+                                         num_chunks),
+         static_cast<int>(static_cast<int64>(n) * (chunk + 1) / num_chunks));
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int t = 1; t < num_threads; ++t) threads.emplace_back(worker, t);
+  worker(0);
+  for (auto& thread : threads) thread.join();
+}
+
+// Calls "fn(thread, i)" for each i in [0, n) using the given number of
+// threads (see ParallelForChunks).  Indices are handed out in blocks so that
+// threads rarely contend with each other even when "fn" is cheap.
+template <class Function>
+void ParallelFor(int n, int num_threads, const Function& fn) {
+  const int kBlockSize = 64;
+  ParallelForChunks(n, (n + kBlockSize - 1) / kBlockSize, num_threads,
+                    [&fn](int thread, int chunk, int begin, int end) {
+                      for (int i = begin; i < end; ++i) fn(thread, i);
+                    });
+}
+
+}  // namespace internal
+}  // namespace S2
+
+#endif  // S2_S2PARALLEL_INTERNAL_H_
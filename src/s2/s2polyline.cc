@@ -28,10 +28,14 @@
 #include "s2/base/logging.h"
 #include "s2/third_party/absl/utility/utility.h"
 #include "s2/util/coding/coder.h"
+#include "s2/mutable_s2shape_index.h"
 #include "s2/s1angle.h"
+#include "s2/s1chord_angle.h"
 #include "s2/s1interval.h"
 #include "s2/s2cap.h"
 #include "s2/s2cell.h"
+#include "s2/s2closest_edge_query.h"
+#include "s2/s2crossing_edge_query.h"
 #include "s2/s2debug.h"
 #include "s2/s2edge_crosser.h"
 #include "s2/s2edge_distances.h"
@@ -42,6 +46,7 @@
 #include "s2/s2predicates.h"
 #include "s2/util/math/matrix3x3.h"
 
+using absl::make_unique;
 using std::max;
 using std::min;
 using std::set;
@@ -49,22 +54,48 @@ using std::vector;
 
 static const unsigned char kCurrentLosslessEncodingVersionNumber = 1;
 
+// Polylines with at most this many vertices are always searched by brute
+// force, and the index is built only after this many brute force queries
+// (see S2Loop::Contains(S2Point) for the reasoning behind these values).
+static const int kMaxBruteForceVertices = 32;
+static const int kMaxUnindexedCalls = 20;
+
 S2Polyline::S2Polyline()
   : s2debug_override_(S2Debug::ALLOW) {}
 
 S2Polyline::S2Polyline(S2Polyline&& other)
   : s2debug_override_(other.s2debug_override_),
     num_vertices_(absl::exchange(other.num_vertices_, 0)),
-    vertices_(std::move(other.vertices_)) {
+    vertices_(std::move(other.vertices_)),
+    index_(std::move(other.index_)),
+    unindexed_calls_(other.unindexed_calls_.load(std::memory_order_relaxed)),
+    query_(std::move(other.query_)),
+    cumulative_lengths_(std::move(other.cumulative_lengths_)) {
+  MoveIndexFrom(&other);
 }
 
 S2Polyline& S2Polyline::operator=(S2Polyline&& other) {
   s2debug_override_ = other.s2debug_override_;
   num_vertices_ = absl::exchange(other.num_vertices_, 0);
   vertices_ = std::move(other.vertices_);
+  index_ = std::move(other.index_);
+  unindexed_calls_.store(other.unindexed_calls_.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+  query_ = std::move(other.query_);
+  cumulative_lengths_ = std::move(other.cumulative_lengths_);
+  MoveIndexFrom(&other);
   return *this;
 }
 
+void S2Polyline::MoveIndexFrom(S2Polyline* other) {
+  // The vertex array is moved without being copied, so the index cells
+  // remain valid and only the indexed shape needs to refer to this polyline.
+  if (index_ != nullptr) {
+    static_cast<Shape*>(index_->shape(0))->Init(this);
+  }
+  other->InitIndex();
+}
+
 S2Polyline::S2Polyline(const vector<S2Point>& vertices)
   : S2Polyline(vertices, S2Debug::ALLOW) {}
 
@@ -98,6 +129,7 @@ void S2Polyline::Init(const vector<S2Point>& vertices) {
   num_vertices_ = vertices.size();
   vertices_.reset(new S2Point[num_vertices_]);
   std::copy(vertices.begin(), vertices.end(), &vertices_[0]);
+  InitIndex();
   if (FLAGS_s2debug && s2debug_override_ == S2Debug::ALLOW) {
     S2_CHECK(IsValid());
   }
@@ -109,11 +141,32 @@ void S2Polyline::Init(const vector<S2LatLng>& vertices) {
   for (int i = 0; i < num_vertices_; ++i) {
     vertices_[i] = vertices[i].ToPoint();
   }
+  InitIndex();
   if (FLAGS_s2debug && s2debug_override_ == S2Debug::ALLOW) {
     S2_CHECK(IsValid());
   }
 }
 
+void S2Polyline::InitIndex() {
+  // The vertices have changed, so the cumulative lengths are also invalid.
+  cumulative_lengths_.clear();
+  unindexed_calls_.store(0, std::memory_order_relaxed);
+  query_.reset();
+  if (num_vertices_ <= kMaxBruteForceVertices) {
+    index_.reset();
+    return;
+  }
+  index_ = make_unique<MutableS2ShapeIndex>();
+  index_->Add(make_unique<Shape>(this));
+}
+
+bool S2Polyline::UseIndex() const {
+  if (index_ == nullptr) return false;
+  // The index is built automatically the first time it is queried.
+  return (index_->is_fresh() ||
+          ++unindexed_calls_ == kMaxUnindexedCalls);
+}
+
 bool S2Polyline::IsValid() const {
   S2Error error;
   if (FindValidationError(&error)) {
@@ -151,6 +204,8 @@ S2Polyline::S2Polyline(const S2Polyline& src)
   : num_vertices_(src.num_vertices_),
     vertices_(new S2Point[num_vertices_]) {
   std::copy(&src.vertices_[0], &src.vertices_[num_vertices_], &vertices_[0]);
+  InitIndex();
+  cumulative_lengths_ = src.cumulative_lengths_;
 }
 
 S2Polyline* S2Polyline::Clone() const {
@@ -158,9 +213,43 @@ S2Polyline* S2Polyline::Clone() const {
 }
 
 S1Angle S2Polyline::GetLength() const {
+  if (has_cumulative_lengths()) return cumulative_lengths_.back();
   return S2::GetLength(S2PointSpan(&vertices_[0], num_vertices_));
 }
 
+void S2Polyline::GetCumulativeLengths(vector<S1Angle>* lengths) const {
+  // The lengths are summed in the same order as GetSuffix() and
+  // UnInterpolate() do without the table.
+  lengths->resize(num_vertices());
+  S1Angle length_sum;
+  for (int i = 0; i < num_vertices(); ++i) {
+    if (i > 0) length_sum += S1Angle(vertex(i-1), vertex(i));
+    (*lengths)[i] = length_sum;
+  }
+}
+
+void S2Polyline::InitCumulativeLengths() {
+  GetCumulativeLengths(&cumulative_lengths_);
+}
+
+// Given the cumulative lengths of "polyline", returns the point at distance
+// "target" from vertex 0, where "i" is the smallest index such that
+// target < lengths[i] (or num_vertices() if there is no such index).  Also
+// sets "next_vertex" as described for S2Polyline::GetSuffix().
+static S2Point GetPointAtLength(const S2Polyline& polyline,
+                                const vector<S1Angle>& lengths,
+                                S1Angle target, int i, int* next_vertex) {
+  if (i == polyline.num_vertices()) {
+    *next_vertex = polyline.num_vertices();
+    return polyline.vertex(polyline.num_vertices() - 1);
+  }
+  S2Point result = S2::InterpolateAtDistance(
+      target - lengths[i-1], polyline.vertex(i-1), polyline.vertex(i));
+  // It is possible that (result == vertex(i)) due to rounding errors.
+  *next_vertex = (result == polyline.vertex(i)) ? (i + 1) : i;
+  return result;
+}
+
 S2Point S2Polyline::GetCentroid() const {
   return S2::GetCentroid(S2PointSpan(&vertices_[0], num_vertices_));
 }
@@ -174,6 +263,14 @@ S2Point S2Polyline::GetSuffix(double fraction, int* next_vertex) const {
     *next_vertex = 1;
     return vertex(0);
   }
+  if (has_cumulative_lengths()) {
+    S1Angle target = fraction * cumulative_lengths_.back();
+    int i = std::upper_bound(cumulative_lengths_.begin() + 1,
+                             cumulative_lengths_.end(), target) -
+            cumulative_lengths_.begin();
+    return GetPointAtLength(*this, cumulative_lengths_, target, i,
+                            next_vertex);
+  }
   S1Angle length_sum;
   for (int i = 1; i < num_vertices(); ++i) {
     length_sum += S1Angle(vertex(i-1), vertex(i));
@@ -201,11 +298,44 @@ S2Point S2Polyline::Interpolate(double fraction) const {
   return GetSuffix(fraction, &next_vertex);
 }
 
+void S2Polyline::InterpolateMany(absl::Span<const double> fractions,
+                                 vector<S2Point>* points) const {
+  S2_DCHECK_GT(num_vertices(), 0);
+  points->resize(fractions.size());
+  vector<S1Angle> temp_lengths;
+  if (!has_cumulative_lengths()) GetCumulativeLengths(&temp_lengths);
+  const vector<S1Angle>& lengths =
+      has_cumulative_lengths() ? cumulative_lengths_ : temp_lengths;
+
+  // Each point is found by scanning forward from the edge containing the
+  // previous point, falling back to binary search if the fractions decrease.
+  int i = 1, next_vertex;
+  for (int k = 0; k < fractions.size(); ++k) {
+    if (fractions[k] <= 0) {
+      (*points)[k] = vertex(0);
+      continue;
+    }
+    S1Angle target = fractions[k] * lengths.back();
+    if (target < lengths[i-1]) {
+      i = std::upper_bound(lengths.begin() + 1, lengths.begin() + i, target) -
+          lengths.begin();
+    } else {
+      while (i < num_vertices() && !(target < lengths[i])) ++i;
+    }
+    (*points)[k] = GetPointAtLength(*this, lengths, target, i, &next_vertex);
+  }
+}
+
 double S2Polyline::UnInterpolate(const S2Point& point, int next_vertex) const {
   S2_DCHECK_GT(num_vertices(), 0);
   if (num_vertices() < 2) {
     return 0;
   }
+  if (has_cumulative_lengths()) {
+    S1Angle length_to_point = cumulative_lengths_[next_vertex-1] +
+                              S1Angle(vertex(next_vertex-1), point);
+    return min(1.0, length_to_point / cumulative_lengths_.back());
+  }
   S1Angle length_sum;
   for (int i = 1; i < next_vertex; ++i) {
     length_sum += S1Angle(vertex(i-1), vertex(i));
@@ -219,6 +349,33 @@ double S2Polyline::UnInterpolate(const S2Point& point, int next_vertex) const {
   return min(1.0, length_to_point / length_sum);
 }
 
+// Returns the point on edge "edge" of "polyline" that is closest to "point",
+// and sets "next_vertex" as described for S2Polyline::Project().
+static S2Point ProjectToEdge(const S2Polyline& polyline, const S2Point& point,
+                             int edge, int* next_vertex) {
+  const int min_index = edge + 1;
+  S2Point closest_point = S2::Project(point, polyline.vertex(min_index - 1),
+                                      polyline.vertex(min_index));
+  *next_vertex =
+      min_index + (closest_point == polyline.vertex(min_index) ? 1 : 0);
+  return closest_point;
+}
+
+int S2Polyline::GetClosestEdge(const S2Point& point) const {
+  S2ClosestEdgeQuery::PointTarget target(point);
+  if (query_in_use_.exchange(true, std::memory_order_acquire)) {
+    // Another thread is using the cached query.
+    S2ClosestEdgeQuery query(index_.get());
+    return query.FindClosestEdge(&target).edge_id();
+  }
+  if (query_ == nullptr) {
+    query_ = make_unique<S2ClosestEdgeQuery>(index_.get());
+  }
+  int edge_id = query_->FindClosestEdge(&target).edge_id();
+  query_in_use_.store(false, std::memory_order_release);
+  return edge_id;
+}
+
 S2Point S2Polyline::Project(const S2Point& point, int* next_vertex) const {
   S2_DCHECK_GT(num_vertices(), 0);
 
@@ -227,28 +384,69 @@ S2Point S2Polyline::Project(const S2Point& point, int* next_vertex) const {
     *next_vertex = 1;
     return vertex(0);
   }
-
-  // Initial value larger than any possible distance on the unit sphere.
-  S1Angle min_distance = S1Angle::Radians(10);
-  int min_index = -1;
+  if (UseIndex()) {
+    return ProjectToEdge(*this, point, GetClosestEdge(point), next_vertex);
+  }
 
   // Find the line segment in the polyline that is closest to the point given.
+  // Distances are compared as S1ChordAngles (as S2ClosestEdgeQuery does) so
+  // that both methods choose the same edge.
+  S1ChordAngle min_distance = S1ChordAngle::Infinity();
+  int min_index = -1;
   for (int i = 1; i < num_vertices(); ++i) {
-    S1Angle distance_to_segment = S2::GetDistance(point, vertex(i-1),
-                                                          vertex(i));
-    if (distance_to_segment < min_distance) {
-      min_distance = distance_to_segment;
+    if (S2::UpdateMinDistance(point, vertex(i-1), vertex(i), &min_distance)) {
       min_index = i;
     }
   }
   S2_DCHECK_NE(min_index, -1);
 
   // Compute the point on the segment found that is closest to the point given.
-  S2Point closest_point =
-      S2::Project(point, vertex(min_index - 1), vertex(min_index));
+  return ProjectToEdge(*this, point, min_index - 1, next_vertex);
+}
 
-  *next_vertex = min_index + (closest_point == vertex(min_index) ? 1 : 0);
-  return closest_point;
+void S2Polyline::ProjectMany(absl::Span<const S2Point> points,
+                             vector<S2Point>* projections,
+                             vector<int>* next_vertices) const {
+  S2_DCHECK_GT(num_vertices(), 0);
+  const int n = points.size();
+  projections->resize(n);
+  next_vertices->resize(n);
+  // Building the index is worthwhile if we have enough points.
+  if (index_ == nullptr ||
+      (n < kMaxUnindexedCalls && !UseIndex())) {
+    for (int i = 0; i < n; ++i) {
+      (*projections)[i] = Project(points[i], &(*next_vertices)[i]);
+    }
+    return;
+  }
+  // The distance to the edges that follow the previous result is usually
+  // close to the minimum, in which case the query only needs to examine the
+  // index cells near the point.
+  static const int kNumHintEdges = 8;
+  const int num_edges = num_vertices() - 1;
+  S2ClosestEdgeQuery query(index_.get());
+  int prev_edge = -1;
+  for (int i = 0; i < n; ++i) {
+    const S2Point& point = points[i];
+    S1ChordAngle hint_distance = S1ChordAngle::Infinity();
+    int hint_edge = -1;
+    if (prev_edge >= 0) {
+      const int end = min(num_edges, prev_edge + kNumHintEdges);
+      for (int e = prev_edge; e < end; ++e) {
+        if (S2::UpdateMinDistance(point, vertex(e), vertex(e + 1),
+                                  &hint_distance)) {
+          hint_edge = e;
+        }
+      }
+    }
+    // Look for an edge that is strictly closer than the hint.
+    query.mutable_options()->set_max_distance(hint_distance);
+    S2ClosestEdgeQuery::PointTarget target(point);
+    S2ClosestEdgeQuery::Result result = query.FindClosestEdge(&target);
+    prev_edge = result.is_empty() ? hint_edge : result.edge_id();
+    (*projections)[i] = ProjectToEdge(*this, point, prev_edge,
+                                      &(*next_vertices)[i]);
+  }
 }
 
 bool S2Polyline::IsOnRight(const S2Point& point) const {
@@ -288,7 +486,8 @@ bool S2Polyline::Intersects(const S2Polyline* line) const {
     return false;
   }
 
-  // TODO(ericv): Use S2ShapeIndex here.
+  if (UseIndex()) return IntersectsIndexed(*line);
+  if (line->UseIndex()) return line->IntersectsIndexed(*this);
   for (int i = 1; i < num_vertices(); ++i) {
     S2EdgeCrosser crosser(
         &vertex(i - 1), &vertex(i), &line->vertex(0));
@@ -301,8 +500,24 @@ bool S2Polyline::Intersects(const S2Polyline* line) const {
   return false;
 }
 
+bool S2Polyline::IntersectsIndexed(const S2Polyline& line) const {
+  S2CrossingEdgeQuery query(index_.get());
+  for (int j = 1; j < line.num_vertices(); ++j) {
+    S2EdgeCrosser crosser(&line.vertex(j - 1), &line.vertex(j));
+    bool crossing = !query.VisitRawCandidates(
+        line.vertex(j - 1), line.vertex(j),
+        [this, &crosser](const s2shapeutil::ShapeEdgeId& id) {
+          int i = id.edge_id;
+          return crosser.CrossingSign(&vertex(i), &vertex(i + 1)) < 0;
+        });
+    if (crossing) return true;
+  }
+  return false;
+}
+
 void S2Polyline::Reverse() {
   std::reverse(&vertices_[0], &vertices_[num_vertices_]);
+  InitIndex();
 }
 
 S2LatLngRect S2Polyline::GetRectBound() const {
@@ -360,6 +575,7 @@ bool S2Polyline::Decode(Decoder* const decoder) {
 
   num_vertices_ = decoder->get32();
   vertices_.reset(new S2Point[num_vertices_]);
+  InitIndex();
   if (decoder->avail() < num_vertices_ * sizeof(vertices_[0])) return false;
   decoder->getn(&vertices_[0], num_vertices_ * sizeof(vertices_[0]));
 
@@ -487,7 +703,10 @@ bool S2Polyline::ApproxEquals(const S2Polyline& b, S1Angle max_error) const {
 }
 
 size_t S2Polyline::SpaceUsed() const {
-  return sizeof(*this) + num_vertices() * sizeof(S2Point);
+  size_t size = sizeof(*this) + num_vertices() * sizeof(S2Point);
+  if (index_ != nullptr) size += index_->SpaceUsed();
+  size += cumulative_lengths_.capacity() * sizeof(S1Angle);
+  return size;
 }
 
 namespace {
@@ -573,14 +792,16 @@ bool S2Polyline::NearlyCovers(const S2Polyline& covered,
 
   if (covered.num_vertices() == 0) return true;
   if (this->num_vertices() == 0) return false;
+  if (max_error < S1Angle::Zero()) return false;
 
   vector<SearchState> pending;
   set<SearchState, SearchStateKeyCompare> done;
 
-  // Find all possible starting states.
-  for (int i = 0, next_i = NextDistinctVertex(*this, 0), next_next_i;
-       next_i < this->num_vertices(); i = next_i, next_i = next_next_i) {
-    next_next_i = NextDistinctVertex(*this, next_i);
+  // Find all possible starting states.  Edge "i" is the edge from the ith
+  // vertex to the next distinct vertex, where "i" is the first of any run of
+  // identical vertices.
+  auto maybe_add_start = [&](int i, int next_i) {
+    const int next_next_i = NextDistinctVertex(*this, next_i);
     S2Point closest_point = S2::Project(
         covered.vertex(0), this->vertex(i), this->vertex(next_i));
 
@@ -591,6 +812,30 @@ bool S2Polyline::NearlyCovers(const S2Polyline& covered,
         S1Angle(closest_point, covered.vertex(0)) <= max_error) {
       pending.push_back(SearchState(i, 0, true));
     }
+  };
+  if (UseIndex()) {
+    // Only the edges near the first vertex of "covered" need to be tested.
+    S2ClosestEdgeQuery::Options options;
+    options.set_conservative_max_distance(S1ChordAngle(max_error));
+    S2ClosestEdgeQuery query(index_.get(), options);
+    S2ClosestEdgeQuery::PointTarget target(covered.vertex(0));
+    vector<int> edges;
+    for (const auto& result : query.FindClosestEdges(&target)) {
+      edges.push_back(result.edge_id());
+    }
+    std::sort(edges.begin(), edges.end());
+    for (int e : edges) {
+      if (this->vertex(e) == this->vertex(e + 1)) continue;  // Degenerate.
+      int i = e;
+      while (i > 0 && this->vertex(i - 1) == this->vertex(i)) --i;
+      maybe_add_start(i, e + 1);
+    }
+  } else {
+    for (int i = 0, next_i = NextDistinctVertex(*this, 0);
+         next_i < this->num_vertices();
+         i = next_i, next_i = NextDistinctVertex(*this, next_i)) {
+      maybe_add_start(i, next_i);
+    }
   }
 
   while (!pending.empty()) {
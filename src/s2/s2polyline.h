@@ -18,9 +18,11 @@
 #ifndef S2_S2POLYLINE_H_
 #define S2_S2POLYLINE_H_
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
+#include "s2/base/integral_types.h"
 #include "s2/base/logging.h"
 #include "s2/_fp_contract_off.h"
 #include "s2/s1angle.h"
@@ -31,12 +33,15 @@
 #include "s2/s2shape.h"
 #include "s2/third_party/absl/base/macros.h"
 #include "s2/third_party/absl/memory/memory.h"
+#include "s2/third_party/absl/types/span.h"
 
 class Decoder;
 class Encoder;
+class MutableS2ShapeIndex;
 class S1Angle;
 class S2Cap;
 class S2Cell;
+class S2ClosestEdgeQuery;
 class S2LatLng;
 
 // An S2Polyline represents a sequence of zero or more vertices connected by
@@ -119,6 +124,18 @@ class S2Polyline final : public S2Region {
   // Return the length of the polyline.
   S1Angle GetLength() const;
 
+  // Precomputes the length of the polyline up to each vertex, which reduces
+  // the cost of Interpolate() and GetSuffix() from linear to logarithmic in
+  // the number of vertices, and UnInterpolate() and GetLength() to constant
+  // time.  This is worthwhile when these methods are called many times on
+  // the same polyline.  The table uses 8 bytes per vertex and is discarded
+  // whenever the vertices change (e.g., by Init(), Decode(), or Reverse()).
+  //
+  // With the table, the results of Interpolate() and GetSuffix() may differ
+  // from those computed without it due to rounding errors.
+  void InitCumulativeLengths();
+  bool has_cumulative_lengths() const { return !cumulative_lengths_.empty(); }
+
   // Return the true centroid of the polyline multiplied by the length of the
   // polyline (see s2centroids.h for details on centroids).  The result is not
   // unit length, so you may want to normalize it.
@@ -129,11 +146,23 @@ class S2Polyline final : public S2Region {
 
   // Return the point whose distance from vertex 0 along the polyline is the
   // given fraction of the polyline's total length.  Fractions less than zero
-  // or greater than one are clamped.  The return value is unit length.  This
-  // cost of this function is currently linear in the number of vertices.
-  // The polyline must not be empty.
+  // or greater than one are clamped.  The return value is unit length.  The
+  // cost of this function is linear in the number of vertices unless
+  // InitCumulativeLengths() has been called.  The polyline must not be empty.
   S2Point Interpolate(double fraction) const;
 
+  // Like Interpolate(), but sets (*points)[i] to Interpolate(fractions[i])
+  // for each of the given fractions.  If the fractions are in increasing
+  // order the running time is linear in the number of vertices plus the
+  // number of fractions; otherwise each fraction that is smaller than its
+  // predecessor requires a binary search.  The results are identical to
+  // Interpolate() when InitCumulativeLengths() has been called, and may
+  // differ due to rounding errors otherwise.
+  //
+  // The polyline must not be empty.
+  void InterpolateMany(absl::Span<const double> fractions,
+                       std::vector<S2Point>* points) const;
+
   // Like Interpolate(), but also return the index of the next polyline
   // vertex after the interpolated point P.  This allows the caller to easily
   // construct a given suffix of the polyline by concatenating P with the
@@ -167,9 +196,25 @@ class S2Polyline final : public S2Region {
   // here w.r.t. the projected point as opposed to the interpolated point in
   // GetSuffix().
   //
-  // The polyline must be non-empty.
+  // The polyline must be non-empty.  Large polylines build an S2ShapeIndex
+  // of their edges once this method has been called enough times for the
+  // index to pay for itself, after which each call is logarithmic rather
+  // than linear in the number of vertices.
   S2Point Project(const S2Point& point, int* next_vertex) const;
 
+  // Like Project(), but projects each of the given points, setting
+  // (*projections)[i] and (*next_vertices)[i] to the results for points[i].
+  // This is faster than calling Project() repeatedly when consecutive points
+  // project onto nearby parts of the polyline (e.g., a sequence of GPS fixes
+  // along a route), since the edges following the previous result are used
+  // to bound the search for the next one.  The results may differ from
+  // Project() only when several edges are equally close to a point.
+  //
+  // The polyline must be non-empty.
+  void ProjectMany(absl::Span<const S2Point> points,
+                   std::vector<S2Point>* projections,
+                   std::vector<int>* next_vertices) const;
+
   // Returns true if the point given is on the right hand side of the polyline,
   // using a naive definition of "right-hand-sideness" where the point is on
   // the RHS of the polyline iff the point is on the RHS of the line segment in
@@ -183,9 +228,9 @@ class S2Polyline final : public S2Region {
   // polyline endpoint is the only intersection with the other polyline, the
   // function may return true or false arbitrarily.
   //
-  // The running time is quadratic in the number of vertices.  (To intersect
-  // polylines more efficiently, or compute the actual intersection geometry,
-  // use S2BooleanOperation.)
+  // The running time is quadratic in the number of vertices unless one of
+  // the polylines is large enough to use its S2ShapeIndex (see Project).  (To
+  // compute the actual intersection geometry, use S2BooleanOperation.)
   bool Intersects(const S2Polyline* line) const;
 
   // Reverse the order of the polyline vertices.
@@ -361,6 +406,27 @@ class S2Polyline final : public S2Region {
   // its argument.
   S2Polyline(const S2Polyline& src);
 
+  // Creates the S2ShapeIndex for large polylines (see index_ below).  Must be
+  // called whenever the vertices change.
+  void InitIndex();
+
+  // Completes moving the index from "other" to this polyline, and resets the
+  // index of "other" (which no longer has any vertices).
+  void MoveIndexFrom(S2Polyline* other);
+
+  // Returns true if the index should be used to answer the current query,
+  // counting the calls made without it.
+  bool UseIndex() const;
+
+  // Returns the edge closest to "point" using the index.
+  int GetClosestEdge(const S2Point& point) const;
+
+  bool IntersectsIndexed(const S2Polyline& line) const;
+
+  // Sets (*lengths)[i] to the length of the polyline from vertex 0 to
+  // vertex i, for all 0 <= i < num_vertices().
+  void GetCumulativeLengths(std::vector<S1Angle>* lengths) const;
+
   // Allows overriding the automatic validity checking controlled by the
   // --s2debug flag.
   S2Debug s2debug_override_;
@@ -371,6 +437,25 @@ class S2Polyline final : public S2Region {
   int num_vertices_ = 0;
   std::unique_ptr<S2Point[]> vertices_;
 
+  // Spatial index of the polyline edges, or nullptr if the polyline is small
+  // enough that brute force is always faster.  As with S2Loop, the index is
+  // only built once enough queries have been made (or when it is needed by a
+  // query that would be expensive without it), and we count the number of
+  // queries answered without it.  Both the build and the count are
+  // thread-safe.
+  std::unique_ptr<MutableS2ShapeIndex> index_;
+  mutable std::atomic<int32> unindexed_calls_{0};
+
+  // The closest edge query used by GetClosestEdge(), which is created on
+  // first use so that repeated calls to Project() (and IsOnRight()) do not
+  // allocate.  "query_in_use_" is set while a thread owns the query; any
+  // concurrent callers use a temporary query instead.
+  mutable std::unique_ptr<S2ClosestEdgeQuery> query_;
+  mutable std::atomic<bool> query_in_use_{false};
+
+  // The cumulative lengths computed by InitCumulativeLengths(), or empty.
+  std::vector<S1Angle> cumulative_lengths_;
+
 #ifndef SWIG
   void operator=(const S2Polyline&) = delete;
 #endif  // SWIG
@@ -256,8 +256,15 @@ VertexAlignment AlignmentFn(const S2Polyline& a, const S2Polyline& b,
 // PUBLIC API IMPLEMENTATION DETAILS
 
 // This is the constant-space implementation of Dynamic Timewarp that can
-// compute the alignment cost, but not the warp path.
-double GetExactVertexAlignmentCost(const S2Polyline& a, const S2Polyline& b) {
+// compute the alignment cost, but not the warp path.  The cost of a warp path
+// is obtained by folding "combine(path_cost, vertex_pair_cost)" over its
+// vertex pairs, which must be monotonic in both arguments.  Summing the costs
+// yields the Dynamic Timewarp cost, while taking their maximum yields the
+// discrete Frechet distance.
+template <class Combine>
+static double GetConstantSpaceAlignmentCost(const S2Polyline& a,
+                                            const S2Polyline& b,
+                                            const Combine& combine) {
   const int a_n = a.num_vertices();
   const int b_n = b.num_vertices();
   S2_CHECK(a_n > 0) << "A is empty polyline.";
@@ -267,8 +274,8 @@ double GetExactVertexAlignmentCost(const S2Polyline& a, const S2Polyline& b) {
   for (int row = 0; row < a_n; ++row) {
     for (int col = 0; col < b_n; ++col) {
       double up_cost = cost[col];
-      cost[col] = std::min(left_diag_min_cost, up_cost) +
-                  (a.vertex(row) - b.vertex(col)).Norm2();
+      cost[col] = combine(std::min(left_diag_min_cost, up_cost),
+                          (a.vertex(row) - b.vertex(col)).Norm2());
       left_diag_min_cost = std::min(cost[col], up_cost);
     }
     left_diag_min_cost = DOUBLE_MAX;
@@ -276,6 +283,19 @@ double GetExactVertexAlignmentCost(const S2Polyline& a, const S2Polyline& b) {
   return cost.back();
 }
 
+double GetExactVertexAlignmentCost(const S2Polyline& a, const S2Polyline& b) {
+  return GetConstantSpaceAlignmentCost(
+      a, b, [](double path_cost, double cost) { return path_cost + cost; });
+}
+
+S1ChordAngle GetDiscreteFrechetDistance(const S2Polyline& a,
+                                        const S2Polyline& b) {
+  return S1ChordAngle::FromLength2(GetConstantSpaceAlignmentCost(
+      a, b, [](double path_cost, double cost) {
+        return std::max(path_cost, cost);
+      }));
+}
+
 VertexAlignment GetExactVertexAlignment(const S2Polyline& a,
                                         const S2Polyline& b) {
   const int a_n = a.num_vertices();
@@ -20,6 +20,7 @@
 #include <memory>
 #include <vector>
 
+#include "s2/s1chord_angle.h"
 #include "s2/s2polyline.h"
 
 // This library provides code to compute vertex alignments between S2Polylines.
@@ -134,6 +135,19 @@ VertexAlignment GetExactVertexAlignment(const S2Polyline& a,
 // O(max(A,B)). This method provides that space-efficiency optimization.
 double GetExactVertexAlignmentCost(const S2Polyline& a, const S2Polyline& b);
 
+// GetDiscreteFrechetDistance takes two non-empty polylines as input, and
+// returns the discrete Frechet distance between their vertex sequences. This
+// is computed by the same dynamic program as GetExactVertexAlignmentCost,
+// except that the cost of a warp path is the *maximum* (rather than the sum)
+// of the distances between its vertex pairs. Informally, it is the shortest
+// leash that allows a person and a dog to walk along `a` and `b`
+// respectively, moving forward from vertex to vertex. Note that the result
+// depends on the vertex spacing; to approximate the continuous Frechet
+// distance, tessellate both polylines to a suitably small edge length first.
+// This method is O(A*B) in time and O(max(A,B)) in space.
+S1ChordAngle GetDiscreteFrechetDistance(const S2Polyline& a,
+                                        const S2Polyline& b);
+
 // GetApproxVertexAlignment takes two non-empty polylines `a` and `b` as input,
 // and a `radius` paramater GetApproxVertexAlignment (quickly) computes an
 // approximately optimal vertex alignment of points between polylines `a` and
@@ -459,6 +459,51 @@ TEST(S2PolylineAlignmentTest, FuzzedWithBruteForce) {
   }
 }
 
+// Returns the discrete Frechet distance (as a squared chord length) up until
+// vertex i, j using a brute-force recursive solver.
+double GetBruteForceFrechetCost(const CostTable& table, const int i,
+                                const int j) {
+  if (i == 0 && j == 0) {
+    return table[0][0];
+  } else if (i == 0) {
+    return std::max(GetBruteForceFrechetCost(table, i, j - 1), table[i][j]);
+  } else if (j == 0) {
+    return std::max(GetBruteForceFrechetCost(table, i - 1, j), table[i][j]);
+  } else {
+    return std::max(std::min({GetBruteForceFrechetCost(table, i - 1, j - 1),
+                              GetBruteForceFrechetCost(table, i - 1, j),
+                              GetBruteForceFrechetCost(table, i, j - 1)}),
+                    table[i][j]);
+  }
+}
+
+TEST(S2PolylineAlignmentTest, FrechetHeaderFileExample) {
+  // With the alignment {(0, 0), (1, 1), (2, 1), (3, 2)} every pair of
+  // vertices is within 2 degrees, and vertex (5, 0) of "a" is 2 degrees from
+  // its closest vertex in "b", so no alignment can do better.
+  const auto a = s2textformat::MakePolylineOrDie("1:0, 5:0, 6:0, 9:0");
+  const auto b = s2textformat::MakePolylineOrDie("2:0, 7:0, 8:0");
+  EXPECT_NEAR(2.0, GetDiscreteFrechetDistance(*a, *b).degrees(), 1e-13);
+  EXPECT_EQ(GetDiscreteFrechetDistance(*a, *b),
+            GetDiscreteFrechetDistance(*b, *a));
+}
+
+TEST(S2PolylineAlignmentTest, FrechetFuzzedWithBruteForce) {
+  const int kNumPolylines = 10;
+  const int kNumVertices = 8;
+  const double kPerturbation = 1.5;
+  const auto lines = GenPolylines(kNumPolylines, kNumVertices, kPerturbation);
+  for (int i = 0; i < kNumPolylines; ++i) {
+    for (int j = i + 1; j < kNumPolylines; ++j) {
+      const double brute_cost = GetBruteForceFrechetCost(
+          DistanceMatrix(*lines[i], *lines[j]), kNumVertices - 1,
+          kNumVertices - 1);
+      EXPECT_EQ(brute_cost,
+                GetDiscreteFrechetDistance(*lines[i], *lines[j]).length2());
+    }
+  }
+}
+
 // TESTS FOR TRAJECTORY CONSENSUS ALGORITHMS
 
 // Tests for GetMedoidPolyline
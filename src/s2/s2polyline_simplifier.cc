@@ -17,10 +17,14 @@
 
 #include "s2/s2polyline_simplifier.h"
 
+#include <algorithm>
 #include <cfloat>
 
 #include "s2/s1chord_angle.h"
 #include "s2/s1interval.h"
+#include "s2/s2parallel_internal.h"
+
+using std::vector;
 
 void S2PolylineSimplifier::Init(const S2Point& src) {
   src_ = src;
@@ -185,3 +189,67 @@ double S2PolylineSimplifier::GetSemiwidth(const S2Point& p, S1ChordAngle r,
   double error = (2 * 10 + 4) * DBL_ERR + 17 * DBL_ERR * semiwidth;
   return semiwidth + round_direction * error;
 }
+
+// Returns the largest index "end" such that the vertices strictly between
+// "index" and "end" can be replaced by the single edge (index, end).  The
+// result is always at least index + 1.
+static int FindEndVertex(absl::Span<const S2Point> vertices,
+                         S1ChordAngle tolerance, int index,
+                         S2PolylineSimplifier* simplifier) {
+  const S2Point& origin = vertices[index];
+  simplifier->Init(origin);
+
+  // The distance to the last vertex must be non-decreasing, except within
+  // the initial disc around the origin.
+  S1ChordAngle last_distance = S1ChordAngle::Zero();
+  const int n = vertices.size();
+  for (++index; index < n; ++index) {
+    const S2Point& candidate = vertices[index];
+    S1ChordAngle distance(origin, candidate);
+
+    // Extend() does not allow edges longer than 90 degrees, but we need to
+    // allow for original edges that are this long.
+    if (last_distance > S1ChordAngle::Zero() &&
+        !simplifier->Extend(candidate)) {
+      break;
+    }
+    if (distance < last_distance && last_distance > tolerance) break;
+    last_distance = distance;
+
+    // Discs that contain the origin do not constrain the edge direction, and
+    // TargetDisc() ignores them.
+    simplifier->TargetDisc(candidate, tolerance);
+  }
+  return index - 1;
+}
+
+void S2PolylineSimplifier::SimplifyChain(absl::Span<const S2Point> vertices,
+                                         S1ChordAngle tolerance,
+                                         vector<int>* indices) {
+  indices->clear();
+  if (vertices.empty()) return;
+
+  indices->push_back(0);
+  tolerance = std::max(tolerance, S1ChordAngle::Zero());
+  S2PolylineSimplifier simplifier;
+  const int n = vertices.size();
+  for (int index = 0; index + 1 < n; ) {
+    int next_index = FindEndVertex(vertices, tolerance, index, &simplifier);
+    // Don't create duplicate adjacent vertices.
+    if (vertices[next_index] != vertices[index]) {
+      indices->push_back(next_index);
+    }
+    index = next_index;
+  }
+}
+
+void S2PolylineSimplifier::SimplifyChains(const vector<vector<S2Point>>& chains,
+                                          S1ChordAngle tolerance,
+                                          vector<vector<int>>* indices,
+                                          int num_threads) {
+  // The output vectors are not cleared here so that their storage is reused.
+  indices->resize(chains.size());
+  S2::internal::ParallelFor(chains.size(), num_threads, [&](int, int i) {
+      SimplifyChain(chains[i], tolerance, &(*indices)[i]);
+    });
+}
@@ -57,9 +57,13 @@
 #ifndef S2_S2POLYLINE_SIMPLIFIER_H_
 #define S2_S2POLYLINE_SIMPLIFIER_H_
 
+#include <vector>
+
 #include "s2/_fp_contract_off.h"
 #include "s2/s1chord_angle.h"
 #include "s2/s1interval.h"
+#include "s2/s2point.h"
+#include "s2/third_party/absl/types/span.h"
 
 class S2PolylineSimplifier {
  public:
@@ -96,6 +100,29 @@ class S2PolylineSimplifier {
   bool AvoidDisc(const S2Point& point, S1ChordAngle radius,
                  bool disc_on_left);
 
+  // Simplifies the polyline with the given vertices and returns the indices
+  // of the vertices that are kept.  The result satisfies the same guarantee
+  // as S2Polyline::SubsampleVertices(): the first and last vertices are
+  // always kept, every vertex that is skipped is within "tolerance" of the
+  // simplified edge that replaces it, and the skipped vertices are
+  // encountered in order along that edge (so that backtracking is never
+  // simplified away by more than "tolerance").  Duplicate adjacent vertices
+  // are not kept.  Returns an empty vector if "vertices" is empty.
+  //
+  // "indices" is cleared before use but its capacity is reused.
+  static void SimplifyChain(absl::Span<const S2Point> vertices,
+                            S1ChordAngle tolerance, std::vector<int>* indices);
+
+  // Like SimplifyChain(), but simplifies many polylines at once (e.g., a
+  // batch of GPS traces).  The polylines are divided among "num_threads"
+  // threads (0 means use one thread per hardware core).  The vectors in
+  // "indices" are reused, so calling this method repeatedly with the same
+  // output avoids most memory allocation.
+  static void SimplifyChains(const std::vector<std::vector<S2Point>>& chains,
+                             S1ChordAngle tolerance,
+                             std::vector<std::vector<int>>* indices,
+                             int num_threads = 1);
+
  private:
   double GetAngle(const S2Point& p) const;
   double GetSemiwidth(const S2Point& p, S1ChordAngle r,
@@ -18,6 +18,7 @@
 #include "s2/s2polyline_simplifier.h"
 
 #include <cfloat>
+#include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -27,6 +28,10 @@
 #include "s2/s2pointutil.h"
 #include "s2/s2testing.h"
 #include "s2/s2text_format.h"
+#include "s2/third_party/absl/strings/str_cat.h"
+
+using std::string;
+using std::vector;
 
 void CheckSimplify(const char* src, const char* dst,
                    const char* target, const char* avoid,
@@ -163,3 +168,103 @@ TEST(S2PolylineSimplifier, Precision) {
     EXPECT_EQ(bad_disc < 0, simplifier.Extend(dst));
   }
 }
+
+static string JoinInts(const vector<int>& ints) {
+  string result;
+  int n = ints.size();
+  for (int i = 0; i + 1 < n; ++i) {
+    absl::StrAppend(&result, ints[i], ",");
+  }
+  if (n > 0) {
+    absl::StrAppend(&result, ints[n - 1]);
+  }
+  return result;
+}
+
+void CheckSimplifyChain(const char* vertices_str, double tolerance_degrees,
+                        const char* expected_str) {
+  vector<S2Point> vertices = s2textformat::ParsePoints(vertices_str);
+  vector<int> indices;
+  S2PolylineSimplifier::SimplifyChain(
+      vertices, S1ChordAngle(S1Angle::Degrees(tolerance_degrees)), &indices);
+  EXPECT_EQ(expected_str, JoinInts(indices))
+      << "\nvertices = " << vertices_str
+      << "\ntolerance = " << tolerance_degrees;
+}
+
+TEST(S2PolylineSimplifier, SimplifyChainMatchesSubsampleVertices) {
+  // These are the examples from S2Polyline::SubsampleVertices(), which makes
+  // the same guarantees.
+  CheckSimplifyChain("", 1.0, "");
+  CheckSimplifyChain("0:1", 1.0, "0");
+  CheckSimplifyChain("10:10, 11:11", 5.0, "0,1");
+  CheckSimplifyChain("-1:0, 0:0, 1:1", 0.0, "0,1,2");
+  CheckSimplifyChain("-1:0, 0:0, 1:1", -1.0, "0,1,2");
+  CheckSimplifyChain("0:1, 0:2, 0:3, 0:4, 0:5", 1.0, "0,4");
+  CheckSimplifyChain("0:1, 0:1, 0:1, 0:2", 0.0, "0,3");
+
+  const char* poly_str("0:0, 0:1, -1:2, 0:3, 0:4, 1:4, 2:4.5, 3:4, 3.5:4, 4:4");
+  CheckSimplifyChain(poly_str, 3.0, "0,9");
+  CheckSimplifyChain(poly_str, 2.0, "0,6,9");
+  CheckSimplifyChain(poly_str, 0.9, "0,2,6,9");
+  CheckSimplifyChain(poly_str, 0.4, "0,1,2,3,4,6,9");
+  CheckSimplifyChain(poly_str, 0, "0,1,2,3,4,5,6,7,8,9");
+
+  // Duplicate vertices, edges longer than 90 degrees, and backtracking.
+  CheckSimplifyChain("10:10, 12:12, 10:10", 5.0, "0");
+  CheckSimplifyChain("0:0, 1:1, 0:0, 0:120, 0:130", 5.0, "0,3,4");
+  CheckSimplifyChain(
+      "90:0, 50:180, 20:180, -20:180, -50:180, -90:0, 30:0, 90:0",
+      5.0, "0,2,4,5,6,7");
+  CheckSimplifyChain("10:10, 10:20, 10:30, 10:15, 10:40", 5.0, "0,2,3,4");
+  CheckSimplifyChain("10:10, 10:20, 10:30, 10:10, 10:30, 10:40", 5.0,
+                     "0,2,3,5");
+  CheckSimplifyChain("10:10, 12:12, 9:9, 10:20, 10:30", 5.0, "0,4");
+}
+
+TEST(S2PolylineSimplifier, SimplifyChainsRandomWalks) {
+  // Simplify a batch of random walks and check that every vertex is within
+  // the tolerance of the simplified edge that replaces it.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  const S1ChordAngle kTolerance(S1Angle::Degrees(0.01));
+  const S1Angle kStep = S1Angle::Degrees(0.005);
+  vector<vector<S2Point>> chains(300);
+  for (auto& chain : chains) {
+    chain.push_back(S2Testing::RandomPoint());
+    int num_vertices = S2Testing::rnd.Uniform(50);
+    for (int i = 1; i < num_vertices; ++i) {
+      chain.push_back(S2::InterpolateAtDistance(
+          kStep, chain.back(), S2Testing::RandomPoint()));
+    }
+  }
+  vector<vector<int>> indices, threaded_indices;
+  S2PolylineSimplifier::SimplifyChains(chains, kTolerance, &indices);
+  for (int i = 0; i < chains.size(); ++i) {
+    const vector<S2Point>& chain = chains[i];
+    const vector<int>& kept = indices[i];
+    if (chain.empty()) {
+      EXPECT_TRUE(kept.empty());
+      continue;
+    }
+    ASSERT_FALSE(kept.empty());
+    EXPECT_EQ(0, kept.front());
+    if (chain.size() > 1) {
+      EXPECT_EQ(chain.size() - 1, static_cast<size_t>(kept.back()));
+    }
+    for (int j = 0; j + 1 < kept.size(); ++j) {
+      const S2Point& a = chain[kept[j]];
+      const S2Point& b = chain[kept[j + 1]];
+      for (int k = kept[j] + 1; k < kept[j + 1]; ++k) {
+        EXPECT_LE(S2::GetDistance(chain[k], a, b),
+                  kTolerance.ToAngle() + S1Angle::Radians(1e-15));
+      }
+    }
+  }
+  // The results do not depend on the number of threads, and the output
+  // vectors may be reused.
+  for (int num_threads : {4, 0, 2}) {
+    S2PolylineSimplifier::SimplifyChains(chains, kTolerance,
+                                         &threaded_indices, num_threads);
+    EXPECT_EQ(indices, threaded_indices);
+  }
+}
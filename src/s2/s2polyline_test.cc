@@ -17,6 +17,7 @@
 
 #include "s2/s2polyline.h"
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <string>
@@ -26,8 +27,11 @@
 #include <gtest/gtest.h>
 
 #include "s2/s1angle.h"
+#include "s2/s2cap.h"
 #include "s2/s2cell.h"
 #include "s2/s2debug.h"
+#include "s2/s2edge_crosser.h"
+#include "s2/s2edge_distances.h"
 #include "s2/s2latlng.h"
 #include "s2/s2pointutil.h"
 #include "s2/s2testing.h"
@@ -58,6 +62,31 @@ unique_ptr<S2Polyline> MakePolyline(const string& str,
   return decoded_polyline;
 }
 
+// Returns a random walk with "num_vertices" vertices that is large enough for
+// S2Polyline to index it.  Each step has length at most "max_step".
+vector<S2Point> MakeRandomWalk(int num_vertices, S1Angle max_step) {
+  vector<S2Point> vertices = {S2Testing::RandomPoint()};
+  while (vertices.size() < num_vertices) {
+    vertices.push_back(S2Testing::SamplePoint(S2Cap(vertices.back(),
+                                                    max_step)));
+  }
+  return vertices;
+}
+
+// Returns the index of the closest edge to "point" by examining every edge.
+int GetClosestEdgeBruteForce(const vector<S2Point>& vertices,
+                             const S2Point& point) {
+  S1ChordAngle min_distance = S1ChordAngle::Infinity();
+  int min_edge = -1;
+  for (int i = 0; i + 1 < vertices.size(); ++i) {
+    if (S2::UpdateMinDistance(point, vertices[i], vertices[i + 1],
+                              &min_distance)) {
+      min_edge = i;
+    }
+  }
+  return min_edge;
+}
+
 TEST(S2Polyline, Basic) {
   vector<S2Point> vertices;
   S2Polyline empty(vertices);
@@ -187,6 +216,60 @@ TEST(S2Polyline, UnInterpolate) {
   EXPECT_DOUBLE_EQ(1.0, line.UnInterpolate(S2Point(0, 1, 0), vertices.size()));
 }
 
+TEST(S2Polyline, CumulativeLengths) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  vector<S2Point> vertices = MakeRandomWalk(200, S1Angle::Degrees(1));
+  S2Polyline line(vertices);
+  // Computing the distance along the polyline in a different order causes
+  // small rounding differences.
+  const S1Angle kMaxError = S1Angle::Radians(1e-13);
+  vector<double> fractions = {-0.1, 0, 1, 1.1};
+  for (int i = 0; i < 100; ++i) {
+    fractions.push_back(S2Testing::rnd.RandDouble());
+  }
+  vector<S2Point> expected_points;
+  vector<int> expected_next_vertices;
+  for (double fraction : fractions) {
+    int next_vertex;
+    expected_points.push_back(line.GetSuffix(fraction, &next_vertex));
+    expected_next_vertices.push_back(next_vertex);
+  }
+  vector<S2Point> points;
+  line.InterpolateMany(fractions, &points);
+  for (int i = 0; i < fractions.size(); ++i) {
+    EXPECT_TRUE(S2::ApproxEquals(expected_points[i], points[i], kMaxError));
+  }
+  S1Angle length = line.GetLength();
+
+  line.InitCumulativeLengths();
+  ASSERT_TRUE(line.has_cumulative_lengths());
+  EXPECT_NEAR(length.radians(), line.GetLength().radians(), 1e-13);
+  for (int i = 0; i < fractions.size(); ++i) {
+    int next_vertex;
+    S2Point point = line.GetSuffix(fractions[i], &next_vertex);
+    EXPECT_TRUE(S2::ApproxEquals(expected_points[i], point, kMaxError));
+    EXPECT_EQ(expected_next_vertices[i], next_vertex);
+    EXPECT_NEAR(std::max(0.0, std::min(1.0, fractions[i])),
+                line.UnInterpolate(point, next_vertex), 1e-13);
+  }
+  // With the table, InterpolateMany() matches Interpolate() exactly whether
+  // or not the fractions are sorted.
+  for (bool sorted : {false, true}) {
+    if (sorted) std::sort(fractions.begin(), fractions.end());
+    line.InterpolateMany(fractions, &points);
+    for (int i = 0; i < fractions.size(); ++i) {
+      EXPECT_EQ(line.Interpolate(fractions[i]), points[i]);
+    }
+  }
+
+  // The table is preserved by moves and discarded when the vertices change.
+  S2Polyline moved(std::move(line));
+  EXPECT_TRUE(moved.has_cumulative_lengths());
+  EXPECT_FALSE(line.has_cumulative_lengths());
+  moved.Reverse();
+  EXPECT_FALSE(moved.has_cumulative_lengths());
+}
+
 TEST(S2Polyline, Project) {
   vector<S2LatLng> latlngs = {
       S2LatLng::FromDegrees(0, 0), S2LatLng::FromDegrees(0, 1),
@@ -221,6 +304,74 @@ TEST(S2Polyline, Project) {
   EXPECT_EQ(4, next_vertex);
 }
 
+TEST(S2Polyline, ProjectLargePolyline) {
+  // Enough points are projected that the polyline builds its index.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  vector<S2Point> vertices = MakeRandomWalk(1000, S1Angle::Degrees(0.01));
+  S2Polyline line(vertices);
+  S2Cap cap = line.GetCapBound();
+  vector<S2Point> points;
+  for (int i = 0; i < 100; ++i) {
+    points.push_back(S2Testing::SamplePoint(cap));
+  }
+  for (const S2Point& point : points) {
+    int next_vertex;
+    S2Point projection = line.Project(point, &next_vertex);
+    int edge = GetClosestEdgeBruteForce(vertices, point);
+    EXPECT_EQ(S2::Project(point, vertices[edge], vertices[edge + 1]),
+              projection);
+    EXPECT_EQ(edge + (projection == vertices[edge + 1] ? 2 : 1), next_vertex);
+  }
+
+  // Now project points that follow the polyline, as in map matching.
+  points.clear();
+  for (int i = 0; i < 300; ++i) {
+    points.push_back(S2Testing::SamplePoint(S2Cap(
+        line.Interpolate(i / 300.0), S1Angle::Degrees(0.005))));
+  }
+  vector<S2Point> projections;
+  vector<int> next_vertices;
+  line.ProjectMany(points, &projections, &next_vertices);
+  ASSERT_EQ(points.size(), projections.size());
+  ASSERT_EQ(points.size(), next_vertices.size());
+  for (int i = 0; i < points.size(); ++i) {
+    int next_vertex;
+    EXPECT_EQ(line.Project(points[i], &next_vertex), projections[i]);
+    EXPECT_EQ(next_vertex, next_vertices[i]);
+  }
+}
+
+TEST(S2Polyline, MoveLargePolylineKeepsIndex) {
+  // Moving a polyline moves its index, which must then refer to the new
+  // polyline.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  vector<S2Point> vertices = MakeRandomWalk(100, S1Angle::Degrees(0.01));
+  S2Polyline line(vertices);
+  S2Cap cap = line.GetCapBound();
+  vector<S2Point> points;
+  for (int i = 0; i < 50; ++i) {
+    points.push_back(S2Testing::SamplePoint(cap));
+  }
+  int next_vertex;
+  for (const S2Point& point : points) line.Project(point, &next_vertex);
+  size_t space_used = line.SpaceUsed();
+
+  vector<S2Polyline> lines;
+  lines.push_back(std::move(line));
+  EXPECT_EQ(0, line.num_vertices());
+  for (int i = 0; i < 10; ++i) {
+    lines.push_back(S2Polyline(vertices));  // Forces reallocation.
+  }
+  S2Polyline assigned;
+  assigned = std::move(lines[0]);
+  EXPECT_EQ(space_used, assigned.SpaceUsed());
+  for (const S2Point& point : points) {
+    int edge = GetClosestEdgeBruteForce(vertices, point);
+    EXPECT_EQ(S2::Project(point, vertices[edge], vertices[edge + 1]),
+              assigned.Project(point, &next_vertex));
+  }
+}
+
 TEST(S2Polyline, IsOnRight) {
   vector<S2LatLng> latlngs = {
       S2LatLng::FromDegrees(0, 0), S2LatLng::FromDegrees(0, 1),
@@ -291,6 +442,32 @@ TEST(S2Polyline, IntersectsVertexOnEdge)  {
       vertical_top_to_bottom.get()));
 }
 
+TEST(S2Polyline, IntersectsLargePolyline) {
+  // Compare against testing every pair of edges, in both directions so that
+  // both the index of "line" and the brute force loop are used.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  vector<S2Point> vertices = MakeRandomWalk(500, S1Angle::Degrees(0.1));
+  S2Polyline line(vertices);
+  S2Cap cap = line.GetCapBound();
+  int num_intersecting = 0;
+  for (int iter = 0; iter < 100; ++iter) {
+    S2Point a = S2Testing::SamplePoint(cap);
+    S2Polyline other(vector<S2Point>{
+        a, S2Testing::SamplePoint(S2Cap(a, S1Angle::Degrees(0.2)))});
+    bool expected = false;
+    for (int i = 0; i + 1 < vertices.size(); ++i) {
+      S2EdgeCrosser crosser(&vertices[i], &vertices[i + 1]);
+      if (crosser.CrossingSign(&other.vertex(0), &other.vertex(1)) >= 0) {
+        expected = true;
+      }
+    }
+    EXPECT_EQ(expected, line.Intersects(&other));
+    EXPECT_EQ(expected, other.Intersects(&line));
+    num_intersecting += expected;
+  }
+  EXPECT_GT(num_intersecting, 0);
+}
+
 TEST(S2Polyline, SpaceUsedEmptyPolyline)  {
   unique_ptr<S2Polyline> line(MakePolyline(""));
   EXPECT_GT(line->SpaceUsed(), 0);
@@ -543,6 +720,23 @@ TEST(S2PolylineCoveringTest, MatchStartsAtDuplicatedLastVertex) {
       "0:0, 0:2, 0:2, 0:2", "0:2, 0:3", 1.5, false, true, S2Debug::DISABLE);
 }
 
+TEST(S2PolylineCoveringTest, LargePolylineCoversSubpath) {
+  // Make enough calls that the covering polyline builds its index.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  vector<S2Point> vertices = MakeRandomWalk(500, S1Angle::Degrees(0.1));
+  S2Polyline line(vertices);
+  for (int iter = 0; iter < 30; ++iter) {
+    int begin = S2Testing::rnd.Uniform(400);
+    vector<S2Point> subpath(vertices.begin() + begin,
+                            vertices.begin() + begin + 50);
+    S2Polyline covered(subpath);
+    EXPECT_TRUE(line.NearlyCovers(covered, S1Angle::Degrees(1e-10)));
+    std::reverse(subpath.begin(), subpath.end());
+    S2Polyline reversed(subpath);
+    EXPECT_FALSE(line.NearlyCovers(reversed, S1Angle::Degrees(1e-10)));
+  }
+}
+
 TEST(S2PolylineCoveringTest, EmptyPolylines) {
   // We expect:
   //    anything.covers(empty) = true
@@ -21,6 +21,7 @@
 #include "s2/s2latlng.h"
 
 using std::fabs;
+using std::vector;
 
 namespace S2 {
 
@@ -44,6 +45,22 @@ R2Point Projection::Interpolate(double f,
   return (1 - f) * a + f * b;
 }
 
+void Projection::ProjectBatch(absl::Span<const S2Point> points,
+                              vector<R2Point>* output) const {
+  output->resize(points.size());
+  for (int i = 0; i < points.size(); ++i) {
+    (*output)[i] = Project(points[i]);
+  }
+}
+
+void Projection::UnprojectBatch(absl::Span<const R2Point> points,
+                                vector<S2Point>* output) const {
+  output->resize(points.size());
+  for (int i = 0; i < points.size(); ++i) {
+    (*output)[i] = Unproject(points[i]);
+  }
+}
+
 PlateCarreeProjection::PlateCarreeProjection(double x_scale)
     : x_wrap_(2 * x_scale),
       to_radians_(M_PI / x_scale),
@@ -68,6 +85,27 @@ S2LatLng PlateCarreeProjection::ToLatLng(const R2Point& p) const {
                                to_radians_ * remainder(p.x(), x_wrap_));
 }
 
+// The batch methods below are equivalent to calling Project() and
+// Unproject() for each point, except that the per-point calls are not
+// virtual (and can therefore be inlined).  The results are identical.
+void PlateCarreeProjection::ProjectBatch(absl::Span<const S2Point> points,
+                                         vector<R2Point>* output) const {
+  output->resize(points.size());
+  R2Point* out = output->data();
+  for (int i = 0; i < points.size(); ++i) {
+    out[i] = FromLatLng(S2LatLng(points[i]));
+  }
+}
+
+void PlateCarreeProjection::UnprojectBatch(absl::Span<const R2Point> points,
+                                           vector<S2Point>* output) const {
+  output->resize(points.size());
+  S2Point* out = output->data();
+  for (int i = 0; i < points.size(); ++i) {
+    out[i] = ToLatLng(points[i]).ToPoint();
+  }
+}
+
 R2Point PlateCarreeProjection::wrap_distance() const {
   return R2Point(x_wrap_, 0);
 }
@@ -102,6 +140,38 @@ S2LatLng MercatorProjection::ToLatLng(const R2Point& p) const {
   return S2LatLng::FromRadians(y, x);
 }
 
+void MercatorProjection::ProjectBatch(absl::Span<const S2Point> points,
+                                      vector<R2Point>* output) const {
+  // Rather than computing the latitude and then taking its sine (as
+  // FromLatLng does), we use the identity sin(lat) = z / |p| directly.  This
+  // saves one atan2() and one sin() call per point.
+  output->resize(points.size());
+  R2Point* out = output->data();
+  for (int i = 0; i < points.size(); ++i) {
+    const S2Point& p = points[i];
+    double sin_phi = p.z() / p.Norm();
+    double y = 0.5 * log((1 + sin_phi) / (1 - sin_phi));
+    out[i] = R2Point(from_radians_ * atan2(p.y(), p.x()), from_radians_ * y);
+  }
+}
+
+void MercatorProjection::UnprojectBatch(absl::Span<const R2Point> points,
+                                        vector<S2Point>* output) const {
+  // The inverse Mercator projection satisfies sin(lat) = tanh(y) and
+  // cos(lat) = sech(y), so the point can be computed directly without
+  // evaluating asin(), sin() and cos() of the latitude.  Note that if "y" is
+  // infinite then tanh(y) == +/-1 and sech(y) == 0 as required.
+  output->resize(points.size());
+  S2Point* out = output->data();
+  for (int i = 0; i < points.size(); ++i) {
+    const R2Point& p = points[i];
+    double x = to_radians_ * remainder(p.x(), x_wrap_);
+    double y = to_radians_ * p.y();
+    double cos_phi = 1 / cosh(y);
+    out[i] = S2Point(cos(x) * cos_phi, sin(x) * cos_phi, tanh(y));
+  }
+}
+
 R2Point MercatorProjection::wrap_distance() const {
   return R2Point(x_wrap_, 0);
 }
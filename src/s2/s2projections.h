@@ -22,6 +22,8 @@
 #ifndef S2_S2PROJECTIONS_H_
 #define S2_S2PROJECTIONS_H_
 
+#include <vector>
+#include "s2/third_party/absl/types/span.h"
 #include "s2/r2.h"
 #include "s2/s2latlng.h"
 #include "s2/s2point.h"
@@ -52,6 +54,20 @@ class Projection {
   // implementation may be more efficient.
   virtual S2LatLng ToLatLng(const R2Point& p) const = 0;
 
+  // Projects each of the given points and stores the results in "output"
+  // (which is resized as necessary).  This is useful when a large number of
+  // points must be converted (e.g., for rendering), since subclasses may
+  // override it with an implementation that avoids the per-point virtual
+  // call and uses cheaper formulas.  Such overrides document how closely
+  // their results agree with Project().  The default implementation calls
+  // Project() for each point, which gives exactly the same results.
+  virtual void ProjectBatch(absl::Span<const S2Point> points,
+                            std::vector<R2Point>* output) const;
+
+  // Like ProjectBatch(), but unprojects each of the given points.
+  virtual void UnprojectBatch(absl::Span<const R2Point> points,
+                              std::vector<S2Point>* output) const;
+
   // Returns the point obtained by interpolating the given fraction of the
   // distance along the line from A to B.  Almost all projections should
   // use the default implementation of this method, which simply interpolates
@@ -114,6 +130,10 @@ class PlateCarreeProjection final : public Projection {
   S2Point Unproject(const R2Point& p) const override;
   R2Point FromLatLng(const S2LatLng& ll) const override;
   S2LatLng ToLatLng(const R2Point& p) const override;
+  void ProjectBatch(absl::Span<const S2Point> points,
+                    std::vector<R2Point>* output) const override;
+  void UnprojectBatch(absl::Span<const R2Point> points,
+                      std::vector<S2Point>* output) const override;
   R2Point wrap_distance() const override;
 
  private:
@@ -147,6 +167,20 @@ class MercatorProjection final : public Projection {
   S2Point Unproject(const R2Point& p) const override;
   R2Point FromLatLng(const S2LatLng& ll) const override;
   S2LatLng ToLatLng(const R2Point& p) const override;
+
+  // The "y" coordinates computed by ProjectBatch() differ from those of
+  // Project() by at most about 2 * DBL_EPSILON / cos(lat)**2 radians (scaled
+  // by max_x / Pi), so the error is tiny at low latitudes but grows rapidly
+  // near the poles.  Within about 1e-8 radians of a pole, one method may
+  // return an infinite "y" coordinate where the other does not.  The
+  // "x" coordinates agree to within a few ulps.
+  void ProjectBatch(absl::Span<const S2Point> points,
+                    std::vector<R2Point>* output) const override;
+
+  // The points computed by UnprojectBatch() are within about 1e-14 radians
+  // of those computed by Unproject().
+  void UnprojectBatch(absl::Span<const R2Point> points,
+                      std::vector<S2Point>* output) const override;
   R2Point wrap_distance() const override;
 
  private:
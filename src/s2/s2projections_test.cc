@@ -17,7 +17,10 @@
 
 #include "s2/s2projections.h"
 
+#include <cfloat>
+#include <cmath>
 #include <limits>
+#include <vector>
 #include <gtest/gtest.h>
 #include "s2/s2latlng.h"
 #include "s2/s2pointutil.h"
@@ -75,4 +78,75 @@ TEST(MercatorProjection, ProjectUnproject) {
                        S2LatLng::FromRadians(1, 0).ToPoint());
 }
 
+// Checks that ProjectBatch() and UnprojectBatch() agree with Project() and
+// Unproject() to within "max_error" (measured in projected coordinates and
+// radians respectively).
+void TestBatchMatchesSinglePoints(const Projection& projection,
+                                  double max_error) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  std::vector<S2Point> points;
+  for (int i = 0; i < 1000; ++i) {
+    points.push_back(S2Testing::RandomPoint());
+  }
+  // Include points along the equator and the prime meridian.
+  points.push_back(S2Point(1, 0, 0));
+  points.push_back(S2Point(0, -1, 0));
+  points.push_back(S2LatLng::FromDegrees(-45, 0).ToPoint());
+
+  std::vector<R2Point> projected;
+  projection.ProjectBatch(points, &projected);
+  ASSERT_EQ(points.size(), projected.size());
+  for (int i = 0; i < points.size(); ++i) {
+    R2Point expected = projection.Project(points[i]);
+    EXPECT_NEAR(expected.x(), projected[i].x(), max_error) << points[i];
+    EXPECT_NEAR(expected.y(), projected[i].y(), max_error) << points[i];
+  }
+  std::vector<S2Point> unprojected;
+  projection.UnprojectBatch(projected, &unprojected);
+  ASSERT_EQ(projected.size(), unprojected.size());
+  for (int i = 0; i < projected.size(); ++i) {
+    S2Point expected = projection.Unproject(projected[i]);
+    EXPECT_LE(expected.Angle(unprojected[i]), 1e-14) << projected[i];
+    EXPECT_TRUE(S2::IsUnitLength(unprojected[i]));
+  }
+}
+
+TEST(PlateCarreeProjection, BatchMatchesSinglePoints) {
+  TestBatchMatchesSinglePoints(PlateCarreeProjection(180), 0);
+}
+
+TEST(MercatorProjection, BatchMatchesSinglePoints) {
+  TestBatchMatchesSinglePoints(MercatorProjection(180), 1e-12);
+}
+
+TEST(MercatorProjection, BatchErrorNearPoles) {
+  // The error in "y" is proportional to 1 / cos(lat)**2.
+  MercatorProjection proj(M_PI);
+  std::vector<S2Point> points;
+  for (double dist = 1e-1; dist > 1e-7; dist *= 0.1) {
+    points.push_back(S2LatLng::FromRadians(M_PI_2 - dist, 1).ToPoint());
+    points.push_back(S2LatLng::FromRadians(dist - M_PI_2, -2).ToPoint());
+  }
+  std::vector<R2Point> projected;
+  proj.ProjectBatch(points, &projected);
+  for (int i = 0; i < points.size(); ++i) {
+    double cos_lat = cos(S2LatLng(points[i]).lat().radians());
+    EXPECT_NEAR(proj.Project(points[i]).y(), projected[i].y(),
+                2 * DBL_EPSILON / (cos_lat * cos_lat)) << points[i];
+  }
+}
+
+TEST(MercatorProjection, BatchPoles) {
+  MercatorProjection proj(180);
+  double inf = std::numeric_limits<double>::infinity();
+  std::vector<R2Point> projected;
+  proj.ProjectBatch({S2Point(0, 0, 1), S2Point(0, 0, -1)}, &projected);
+  EXPECT_EQ(inf, projected[0].y());
+  EXPECT_EQ(-inf, projected[1].y());
+  std::vector<S2Point> unprojected;
+  proj.UnprojectBatch({R2Point(0, inf), R2Point(0, -inf)}, &unprojected);
+  EXPECT_EQ(S2Point(0, 0, 1), unprojected[0]);
+  EXPECT_EQ(S2Point(0, 0, -1), unprojected[1]);
+}
+
 }  //  namespace S2
@@ -0,0 +1,155 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2shape_within_distance_query.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include "s2/third_party/absl/memory/memory.h"
+#include "s2/s2cap.h"
+#include "s2/s2cell.h"
+#include "s2/s2cell_id.h"
+#include "s2/s2edge_distances.h"
+#include "s2/s2parallel_internal.h"
+#include "s2/s2shape.h"
+
+using absl::make_unique;
+using std::unique_ptr;
+using std::vector;
+
+S2ShapeWithinDistanceQuery::Options::Options() {
+}
+
+bool S2ShapeWithinDistanceQuery::Options::include_interiors() const {
+  return include_interiors_;
+}
+
+void S2ShapeWithinDistanceQuery::Options::set_include_interiors(
+    bool include_interiors) {
+  include_interiors_ = include_interiors;
+}
+
+S2ShapeWithinDistanceQuery::S2ShapeWithinDistanceQuery(
+    const S2ShapeIndex* index, const Options& options)
+    : index_(index), options_(options), iter_(index) {
+  contains_query_.Init(index);
+}
+
+inline bool S2ShapeWithinDistanceQuery::IsFound(int shape_id) const {
+  return found_[shape_id] == query_id_;
+}
+
+inline void S2ShapeWithinDistanceQuery::AddShape(int shape_id,
+                                                 vector<int>* shape_ids) {
+  found_[shape_id] = query_id_;
+  shape_ids->push_back(shape_id);
+}
+
+void S2ShapeWithinDistanceQuery::FindShapes(const S2Point& point,
+                                            S1ChordAngle max_distance,
+                                            vector<int>* shape_ids) {
+  shape_ids->clear();
+  if (max_distance < S1ChordAngle::Zero()) return;
+
+  // Start a new generation of "found_" marks, clearing them only when the
+  // query counter wraps around.
+  if (query_id_ == std::numeric_limits<int>::max()) {
+    std::fill(found_.begin(), found_.end(), 0);
+    query_id_ = 0;
+  }
+  ++query_id_;
+  found_.resize(index_->num_shape_ids(), 0);
+
+  // Shapes that contain "point" are within any distance of it.
+  if (options_.include_interiors()) {
+    contains_query_.VisitContainingShapes(
+        point, [this, shape_ids](S2Shape* shape) {
+          AddShape(shape->id(), shape_ids);
+          return true;
+        });
+  }
+
+  // Now visit every index cell within range of "point".  UpdateMinDistance()
+  // tests whether the distance is less than its argument, so we use the next
+  // larger distance as the limit.
+  const S1ChordAngle limit = max_distance.Successor();
+  coverer_.GetFastCovering(S2Cap(point, max_distance), &covering_);
+  S2CellId last_id = S2CellId::None();
+  auto maybe_process = [&]() {
+    // An index cell may contain several covering cells.
+    if (iter_.id() == last_id) return;
+    last_id = iter_.id();
+    if (S2Cell(last_id).GetDistance(point) < limit) {
+      ProcessIndexCell(point, limit, shape_ids);
+    }
+  };
+  for (S2CellId id : covering_) {
+    S2ShapeIndex::CellRelation r = iter_.Locate(id);
+    if (r == S2ShapeIndex::INDEXED) {
+      maybe_process();
+    } else if (r == S2ShapeIndex::SUBDIVIDED) {
+      for (S2CellId end = id.range_max();
+           !iter_.done() && iter_.id() <= end; iter_.Next()) {
+        maybe_process();
+      }
+    }
+  }
+  std::sort(shape_ids->begin(), shape_ids->end());
+}
+
+void S2ShapeWithinDistanceQuery::ProcessIndexCell(const S2Point& point,
+                                                  S1ChordAngle limit,
+                                                  vector<int>* shape_ids) {
+  const S2ShapeIndexCell& cell = iter_.cell();
+  for (int s = 0; s < cell.num_clipped(); ++s) {
+    const S2ClippedShape& clipped = cell.clipped(s);
+    int shape_id = clipped.shape_id();
+    if (IsFound(shape_id)) continue;
+    const S2Shape* shape = index_->shape(shape_id);
+    for (int i = 0; i < clipped.num_edges(); ++i) {
+      S2Shape::Edge edge = shape->edge(clipped.edge(i));
+      S1ChordAngle distance = limit;
+      if (S2::UpdateMinDistance(point, edge.v0, edge.v1, &distance)) {
+        // No other edges of this shape need to be examined.
+        AddShape(shape_id, shape_ids);
+        break;
+      }
+    }
+  }
+}
+
+void S2ShapeWithinDistanceQuery::FindShapesForEachPoint(
+    absl::Span<const S2Point> points, S1ChordAngle max_distance,
+    vector<vector<int>>* shape_ids, int num_threads) {
+  // The output vectors are not cleared here so that their storage is reused.
+  shape_ids->resize(points.size());
+  // Each thread other than the calling thread needs its own query.
+  vector<unique_ptr<S2ShapeWithinDistanceQuery>> queries(
+      S2::internal::GetNumThreads(num_threads));
+  S2::internal::ParallelFor(
+      points.size(), num_threads, [&](int thread, int i) {
+        S2ShapeWithinDistanceQuery* query = this;
+        if (thread > 0) {
+          if (queries[thread] == nullptr) {
+            queries[thread] =
+                make_unique<S2ShapeWithinDistanceQuery>(index_, options_);
+          }
+          query = queries[thread].get();
+        }
+        query->FindShapes(points[i], max_distance, &(*shape_ids)[i]);
+      });
+}
@@ -0,0 +1,114 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef S2_S2SHAPE_WITHIN_DISTANCE_QUERY_H_
+#define S2_S2SHAPE_WITHIN_DISTANCE_QUERY_H_
+
+#include <vector>
+
+#include "s2/s1chord_angle.h"
+#include "s2/s2contains_point_query.h"
+#include "s2/s2point.h"
+#include "s2/s2region_coverer.h"
+#include "s2/s2shape_index.h"
+#include "s2/third_party/absl/types/span.h"
+
+// S2ShapeWithinDistanceQuery finds the shapes in an S2ShapeIndex that are
+// within a given distance of a target point (e.g., "which zones are within
+// 500 meters of this location").  Each shape is reported at most once, in
+// order of increasing shape id.
+//
+// This is equivalent to finding all edges within the given distance using
+// S2ClosestEdgeQuery and then removing duplicate shape ids, but it is much
+// faster when the shapes have many nearby edges: no further edges of a shape
+// are examined once the shape is known to be within range, and points inside
+// polygons are found with a single S2ContainsPointQuery rather than by
+// measuring the distance to the polygon boundary.
+//
+// Example usage:
+//
+//   S2ShapeWithinDistanceQuery query(&index);
+//   std::vector<int> shape_ids;
+//   query.FindShapes(point, S1ChordAngle(S2Earth::ToAngle(distance)),
+//                    &shape_ids);
+//
+// This class is not thread-safe, but a single query object may be used to
+// answer any number of queries.  FindShapesForEachPoint() can use multiple
+// threads internally.
+class S2ShapeWithinDistanceQuery {
+ public:
+  class Options {
+   public:
+    Options();
+
+    // If true, a point inside a polygon is at distance zero from it.
+    // Otherwise only the polygon boundary is considered.
+    //
+    // DEFAULT: true
+    bool include_interiors() const;
+    void set_include_interiors(bool include_interiors);
+
+   private:
+    bool include_interiors_ = true;
+  };
+
+  // REQUIRES: "index" must persist for the lifetime of this object.
+  explicit S2ShapeWithinDistanceQuery(const S2ShapeIndex* index,
+                                      const Options& options = Options());
+
+  const S2ShapeIndex& index() const { return *index_; }
+  const Options& options() const { return options_; }
+
+  // Sets "shape_ids" to the ids of all shapes whose distance to "point" is
+  // less than or equal to "max_distance", in increasing order.
+  void FindShapes(const S2Point& point, S1ChordAngle max_distance,
+                  std::vector<int>* shape_ids);
+
+  // Like FindShapes(), but answers a query for each of the given points.
+  // The points are divided among "num_threads" threads (0 means use one
+  // thread per hardware core), each of which uses its own query object.
+  void FindShapesForEachPoint(absl::Span<const S2Point> points,
+                              S1ChordAngle max_distance,
+                              std::vector<std::vector<int>>* shape_ids,
+                              int num_threads = 1);
+
+ private:
+  // Marks "shape_id" as being within range and appends it to the result.
+  void AddShape(int shape_id, std::vector<int>* shape_ids);
+  bool IsFound(int shape_id) const;
+
+  // Tests the edges of every shape in the current index cell that is not
+  // already known to be within range.
+  void ProcessIndexCell(const S2Point& point, S1ChordAngle limit,
+                        std::vector<int>* shape_ids);
+
+  const S2ShapeIndex* index_;
+  Options options_;
+  S2ContainsPointQuery<S2ShapeIndex> contains_query_;
+  S2ShapeIndex::Iterator iter_;
+
+  // Temporary storage that is reused to avoid allocations.  Shape "i" has
+  // been found by the current query if found_[i] == query_id_, which avoids
+  // clearing "found_" between queries.
+  S2RegionCoverer coverer_;
+  std::vector<S2CellId> covering_;
+  std::vector<int> found_;
+  int query_id_ = 0;
+
+  S2ShapeWithinDistanceQuery(const S2ShapeWithinDistanceQuery&) = delete;
+  void operator=(const S2ShapeWithinDistanceQuery&) = delete;
+};
+
+#endif  // S2_S2SHAPE_WITHIN_DISTANCE_QUERY_H_
@@ -0,0 +1,148 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2shape_within_distance_query.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "s2/third_party/absl/memory/memory.h"
+#include "s2/mutable_s2shape_index.h"
+#include "s2/s1angle.h"
+#include "s2/s2cap.h"
+#include "s2/s2closest_edge_query.h"
+#include "s2/s2loop.h"
+#include "s2/s2point_vector_shape.h"
+#include "s2/s2polyline.h"
+#include "s2/s2testing.h"
+#include "s2/s2text_format.h"
+
+using absl::make_unique;
+using std::vector;
+
+namespace {
+
+// Returns the shapes within "max_distance" of "point" by finding all edges
+// within range with S2ClosestEdgeQuery and removing duplicate shape ids.
+vector<int> GetBruteForceShapes(const S2ShapeIndex& index,
+                                const S2Point& point,
+                                S1ChordAngle max_distance,
+                                bool include_interiors) {
+  S2ClosestEdgeQuery::Options options;
+  options.set_inclusive_max_distance(max_distance);
+  options.set_include_interiors(include_interiors);
+  options.set_use_brute_force(true);
+  S2ClosestEdgeQuery query(&index, options);
+  S2ClosestEdgeQuery::PointTarget target(point);
+  vector<int> result;
+  for (const auto& edge : query.FindClosestEdges(&target)) {
+    result.push_back(edge.shape_id());
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+TEST(S2ShapeWithinDistanceQuery, IncludeInteriors) {
+  auto index = s2textformat::MakeIndexOrDie(
+      "0:0 # 2:2, 2:8 # 0:0, 0:10, 10:10, 10:0");
+  S2ShapeWithinDistanceQuery query(index.get());
+  S2Point point = s2textformat::MakePointOrDie("5:5");
+  vector<int> shape_ids;
+  query.FindShapes(point, S1ChordAngle(S1Angle::Degrees(1)), &shape_ids);
+  EXPECT_EQ(vector<int>({2}), shape_ids);
+  query.FindShapes(point, S1ChordAngle(S1Angle::Degrees(3.5)), &shape_ids);
+  EXPECT_EQ(vector<int>({1, 2}), shape_ids);
+  query.FindShapes(point, S1ChordAngle::Negative(), &shape_ids);
+  EXPECT_TRUE(shape_ids.empty());
+
+  S2ShapeWithinDistanceQuery::Options options;
+  options.set_include_interiors(false);
+  S2ShapeWithinDistanceQuery boundary_query(index.get(), options);
+  boundary_query.FindShapes(point, S1ChordAngle(S1Angle::Degrees(3.5)),
+                            &shape_ids);
+  EXPECT_EQ(vector<int>({1}), shape_ids);
+  boundary_query.FindShapes(point, S1ChordAngle(S1Angle::Degrees(10)),
+                            &shape_ids);
+  EXPECT_EQ(vector<int>({0, 1, 2}), shape_ids);
+}
+
+TEST(S2ShapeWithinDistanceQuery, DistanceEqualToLimit) {
+  auto index = s2textformat::MakeIndexOrDie("1:0 # #");
+  S2ShapeWithinDistanceQuery query(index.get());
+  S2Point point = s2textformat::MakePointOrDie("0:0");
+  S1ChordAngle distance(point, s2textformat::MakePointOrDie("1:0"));
+  vector<int> shape_ids;
+  query.FindShapes(point, distance, &shape_ids);
+  EXPECT_EQ(vector<int>({0}), shape_ids);
+  query.FindShapes(point, distance.Predecessor(), &shape_ids);
+  EXPECT_TRUE(shape_ids.empty());
+}
+
+TEST(S2ShapeWithinDistanceQuery, MatchesClosestEdgeQuery) {
+  // Build an index of overlapping fractal loops, polylines, and points, and
+  // compare the results against S2ClosestEdgeQuery for random points.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  const S1Angle kRadius = S1Angle::Degrees(1);
+  S2Cap cap(S2Testing::RandomPoint(), 5 * kRadius);
+  MutableS2ShapeIndex index;
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(100);
+  for (int i = 0; i < 30; ++i) {
+    S2Point center = S2Testing::SamplePoint(cap);
+    switch (i % 3) {
+      case 0:
+        index.Add(make_unique<S2Loop::OwningShape>(fractal.MakeLoop(
+            S2Testing::GetRandomFrameAt(center), kRadius)));
+        break;
+      case 1: {
+        vector<S2Point> vertices;
+        for (int j = 0; j < 20; ++j) {
+          vertices.push_back(S2Testing::SamplePoint(S2Cap(center, kRadius)));
+        }
+        index.Add(make_unique<S2Polyline::OwningShape>(
+            make_unique<S2Polyline>(vertices)));
+        break;
+      }
+      default:
+        index.Add(make_unique<S2PointVectorShape>(vector<S2Point>{center}));
+        break;
+    }
+  }
+  vector<S2Point> points;
+  for (int i = 0; i < 300; ++i) {
+    points.push_back(S2Testing::SamplePoint(cap));
+  }
+  S1ChordAngle max_distance(0.5 * kRadius);
+  for (bool include_interiors : {true, false}) {
+    S2ShapeWithinDistanceQuery::Options options;
+    options.set_include_interiors(include_interiors);
+    S2ShapeWithinDistanceQuery query(&index, options);
+    vector<vector<int>> shape_ids, threaded_shape_ids;
+    query.FindShapesForEachPoint(points, max_distance, &shape_ids);
+    for (int i = 0; i < points.size(); ++i) {
+      EXPECT_EQ(GetBruteForceShapes(index, points[i], max_distance,
+                                    include_interiors),
+                shape_ids[i]);
+    }
+    query.FindShapesForEachPoint(points, max_distance, &threaded_shape_ids,
+                                 3 /*num_threads*/);
+    EXPECT_EQ(shape_ids, threaded_shape_ids);
+  }
+}
+
+}  // namespace
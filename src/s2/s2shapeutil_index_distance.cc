@@ -0,0 +1,286 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2shapeutil_index_distance.h"
+
+#include <algorithm>
+#include <queue>
+
+#include "s2/base/logging.h"
+#include "s2/s2boolean_operation.h"
+#include "s2/s2cell.h"
+#include "s2/s2cell_id.h"
+#include "s2/s2edge_distances.h"
+
+using std::pair;
+using std::vector;
+
+namespace s2shapeutil {
+
+namespace {
+
+// A cell in the hierarchy of one of the two indexes.  Leaf nodes are index
+// cells; other nodes contain one or more index cells.
+struct Node {
+  Node(S2CellId _id, bool _is_leaf) : cell(_id), is_leaf(_is_leaf) {}
+
+  S2Cell cell;
+  bool is_leaf;
+};
+
+// A pair of nodes, one from each index, together with a bound on the
+// distance between them.
+struct NodePair {
+  NodePair(S1ChordAngle _distance, const Node& _a, const Node& _b)
+      : distance(_distance), a(_a), b(_b) {}
+
+  S1ChordAngle distance;
+  Node a, b;
+};
+
+// Sorts NodePairs so that the pair with the smallest distance is at the top
+// of a std::priority_queue.
+struct CloserFirst {
+  bool operator()(const NodePair& x, const NodePair& y) const {
+    return x.distance > y.distance;
+  }
+};
+
+// Sorts NodePairs so that the pair with the largest distance is at the top
+// of a std::priority_queue.
+struct FurtherFirst {
+  bool operator()(const NodePair& x, const NodePair& y) const {
+    return x.distance < y.distance;
+  }
+};
+
+// An edge of an index cell, together with its ShapeEdgeId.
+struct CellEdge {
+  CellEdge(ShapeEdgeId _id, const S2Shape::Edge& _edge)
+      : id(_id), edge(_edge) {}
+
+  ShapeEdgeId id;
+  S2Shape::Edge edge;
+};
+
+// Implements the parts of the dual-tree traversal that are shared between
+// the various distance functions: enumerating the non-empty children of a
+// node, deciding which node of a pair to subdivide, and visiting the edge
+// pairs of two index cells.
+class DualTree {
+ public:
+  DualTree(const S2ShapeIndex& a_index, const S2ShapeIndex& b_index)
+      : a_index_(a_index), b_index_(b_index),
+        a_iter_(&a_index), b_iter_(&b_index) {
+  }
+
+  // Calls "visitor(a, b)" for every pair of top-level nodes.
+  template <class Visitor>
+  void VisitFacePairs(const Visitor& visitor) {
+    vector<Node> a_faces, b_faces;
+    for (int face = 0; face < 6; ++face) {
+      AddNode(&a_iter_, S2CellId::FromFace(face), &a_faces);
+      AddNode(&b_iter_, S2CellId::FromFace(face), &b_faces);
+    }
+    for (const Node& a : a_faces) {
+      for (const Node& b : b_faces) visitor(a, b);
+    }
+  }
+
+  // Given a pair of nodes that are not both leaves, subdivides the larger
+  // node and calls "visitor(a, b)" for each of the resulting pairs.
+  template <class Visitor>
+  void VisitChildPairs(const NodePair& pair, const Visitor& visitor) {
+    const Node& a = pair.a;
+    const Node& b = pair.b;
+    S2_DCHECK(!a.is_leaf || !b.is_leaf);
+    bool split_a =
+        b.is_leaf || (!a.is_leaf && a.cell.level() <= b.cell.level());
+    vector<Node>* children = &children_;
+    children->clear();
+    if (split_a) {
+      AddChildren(&a_iter_, a, children);
+      for (const Node& child : *children) visitor(child, b);
+    } else {
+      AddChildren(&b_iter_, b, children);
+      for (const Node& child : *children) visitor(a, child);
+    }
+  }
+
+  // Calls "visitor(a_edge, b_edge)" for every pair of edges in the given
+  // leaf nodes.
+  template <class Visitor>
+  void VisitEdgePairs(const Node& a, const Node& b, const Visitor& visitor) {
+    GetEdges(a_index_, &a_iter_, a, &a_edges_);
+    GetEdges(b_index_, &b_iter_, b, &b_edges_);
+    for (const CellEdge& a_edge : a_edges_) {
+      for (const CellEdge& b_edge : b_edges_) visitor(a_edge, b_edge);
+    }
+  }
+
+ private:
+  // Appends a node for "id" to "nodes" unless it is disjoint from the index.
+  static void AddNode(S2ShapeIndex::Iterator* iter, S2CellId id,
+                      vector<Node>* nodes) {
+    S2ShapeIndex::CellRelation r = iter->Locate(id);
+    if (r == S2ShapeIndex::DISJOINT) return;
+    // If "id" is contained by an index cell, then it is equal to that cell.
+    // This is because "id" is either a face cell or the child of a node that
+    // was subdivided (and therefore not contained by any index cell).
+    S2_DCHECK(r == S2ShapeIndex::SUBDIVIDED || iter->id() == id);
+    nodes->push_back(Node(id, r == S2ShapeIndex::INDEXED));
+  }
+
+  static void AddChildren(S2ShapeIndex::Iterator* iter, const Node& node,
+                          vector<Node>* children) {
+    S2CellId end = node.cell.id().child_end();
+    for (S2CellId id = node.cell.id().child_begin(); id != end;
+         id = id.next()) {
+      AddNode(iter, id, children);
+    }
+  }
+
+  static void GetEdges(const S2ShapeIndex& index,
+                       S2ShapeIndex::Iterator* iter, const Node& node,
+                       vector<CellEdge>* edges) {
+    edges->clear();
+    iter->Locate(node.cell.id());
+    const S2ShapeIndexCell& cell = iter->cell();
+    for (int s = 0; s < cell.num_clipped(); ++s) {
+      const S2ClippedShape& clipped = cell.clipped(s);
+      const S2Shape* shape = index.shape(clipped.shape_id());
+      for (int i = 0; i < clipped.num_edges(); ++i) {
+        int e = clipped.edge(i);
+        edges->push_back(CellEdge(ShapeEdgeId(clipped.shape_id(), e),
+                                  shape->edge(e)));
+      }
+    }
+  }
+
+  const S2ShapeIndex& a_index_;
+  const S2ShapeIndex& b_index_;
+  S2ShapeIndex::Iterator a_iter_, b_iter_;
+
+  // Temporary storage that is reused to avoid allocations.
+  vector<Node> children_;
+  vector<CellEdge> a_edges_, b_edges_;
+};
+
+}  // namespace
+
+S1ChordAngle GetMinDistance(const S2ShapeIndex& a_index,
+                            const S2ShapeIndex& b_index,
+                            bool include_interiors) {
+  if (include_interiors && S2BooleanOperation::Intersects(a_index, b_index)) {
+    return S1ChordAngle::Zero();
+  }
+  // This is a best-first search: node pairs are processed in order of
+  // increasing lower bound, and the search stops as soon as the lower bound
+  // of the next pair is no better than the closest edge pair found so far.
+  S1ChordAngle min_dist = S1ChordAngle::Infinity();
+  std::priority_queue<NodePair, vector<NodePair>, CloserFirst> queue;
+  auto maybe_enqueue = [&queue, &min_dist](const Node& a, const Node& b) {
+    S1ChordAngle distance = a.cell.GetDistance(b.cell);
+    if (distance < min_dist) queue.push(NodePair(distance, a, b));
+  };
+  DualTree tree(a_index, b_index);
+  tree.VisitFacePairs(maybe_enqueue);
+  while (!queue.empty()) {
+    NodePair pair = queue.top();
+    queue.pop();
+    if (pair.distance >= min_dist) break;
+    if (pair.a.is_leaf && pair.b.is_leaf) {
+      tree.VisitEdgePairs(pair.a, pair.b, [&min_dist](const CellEdge& a,
+                                                      const CellEdge& b) {
+          S2::UpdateEdgePairMinDistance(a.edge.v0, a.edge.v1,
+                                        b.edge.v0, b.edge.v1, &min_dist);
+        });
+      if (min_dist == S1ChordAngle::Zero()) break;
+    } else {
+      tree.VisitChildPairs(pair, maybe_enqueue);
+    }
+  }
+  return min_dist;
+}
+
+S1ChordAngle GetMaxDistance(const S2ShapeIndex& a_index,
+                            const S2ShapeIndex& b_index) {
+  // Like GetMinDistance(), except that node pairs are processed in order of
+  // decreasing upper bound.
+  S1ChordAngle max_dist = S1ChordAngle::Negative();
+  std::priority_queue<NodePair, vector<NodePair>, FurtherFirst> queue;
+  auto maybe_enqueue = [&queue, &max_dist](const Node& a, const Node& b) {
+    S1ChordAngle distance = a.cell.GetMaxDistance(b.cell);
+    if (distance > max_dist) queue.push(NodePair(distance, a, b));
+  };
+  DualTree tree(a_index, b_index);
+  tree.VisitFacePairs(maybe_enqueue);
+  while (!queue.empty()) {
+    NodePair pair = queue.top();
+    queue.pop();
+    if (pair.distance <= max_dist) break;
+    if (pair.a.is_leaf && pair.b.is_leaf) {
+      tree.VisitEdgePairs(pair.a, pair.b, [&max_dist](const CellEdge& a,
+                                                      const CellEdge& b) {
+          S2::UpdateEdgePairMaxDistance(a.edge.v0, a.edge.v1,
+                                        b.edge.v0, b.edge.v1, &max_dist);
+        });
+      if (max_dist == S1ChordAngle::Straight()) break;
+    } else {
+      tree.VisitChildPairs(pair, maybe_enqueue);
+    }
+  }
+  return max_dist;
+}
+
+vector<ShapeEdgeIdPair> GetEdgePairsWithinDistance(
+    const S2ShapeIndex& a_index, const S2ShapeIndex& b_index,
+    S1ChordAngle max_distance) {
+  // Every node pair whose lower bound is within range must be examined, so
+  // the traversal order does not matter and a stack is sufficient.
+  vector<ShapeEdgeIdPair> result;
+  vector<NodePair> stack;
+  auto maybe_push = [&stack, max_distance](const Node& a, const Node& b) {
+    S1ChordAngle distance = a.cell.GetDistance(b.cell);
+    if (distance <= max_distance) stack.push_back(NodePair(distance, a, b));
+  };
+  // UpdateEdgePairMinDistance() tests whether the distance is less than its
+  // argument, so we use the next larger distance as the limit.
+  const S1ChordAngle limit = max_distance.Successor();
+  DualTree tree(a_index, b_index);
+  tree.VisitFacePairs(maybe_push);
+  while (!stack.empty()) {
+    NodePair pair = stack.back();
+    stack.pop_back();
+    if (pair.a.is_leaf && pair.b.is_leaf) {
+      tree.VisitEdgePairs(pair.a, pair.b, [&result, limit](const CellEdge& a,
+                                                           const CellEdge& b) {
+          S1ChordAngle distance = limit;
+          if (S2::UpdateEdgePairMinDistance(a.edge.v0, a.edge.v1,
+                                            b.edge.v0, b.edge.v1, &distance)) {
+            result.push_back(ShapeEdgeIdPair(a.id, b.id));
+          }
+        });
+    } else {
+      tree.VisitChildPairs(pair, maybe_push);
+    }
+  }
+  // Edges that span several index cells may be reported more than once.
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+}  // namespace s2shapeutil
@@ -0,0 +1,80 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef S2_S2SHAPEUTIL_INDEX_DISTANCE_H_
+#define S2_S2SHAPEUTIL_INDEX_DISTANCE_H_
+
+#include <utility>
+#include <vector>
+
+#include "s2/s1chord_angle.h"
+#include "s2/s2shape_index.h"
+#include "s2/s2shapeutil_shape_edge_id.h"
+
+// This file contains functions that measure the distance between the
+// geometry of two S2ShapeIndexes.  They are intended for large inputs (e.g.,
+// two coastlines with 100,000 edges each), where the alternative of using
+// S2ClosestEdgeQuery with an S2MinDistanceShapeIndexTarget is slow because
+// it runs a separate query on the target index for every candidate cell and
+// edge of the query index.
+//
+// Instead these functions descend the cell hierarchies of both indexes
+// simultaneously (a "dual-tree" traversal).  Each step considers a pair of
+// cells (one from each index) and uses the distance bounds between the two
+// cells to decide whether the pair can be discarded.  Otherwise the larger
+// cell is subdivided, until both cells are index cells and the distances
+// between their edges are computed directly.
+//
+// Points are treated as degenerate edges.  Distances are computed with the
+// usual accuracy of S2ClosestEdgeQuery (see s2edge_distances.h).
+
+namespace s2shapeutil {
+
+// Returns the minimum distance between any edge of "a_index" and any edge of
+// "b_index".  If "include_interiors" is true then polygon interiors are
+// included, so that the distance is zero whenever the two geometries
+// intersect (as determined by S2BooleanOperation::Intersects).  Returns
+// S1ChordAngle::Infinity() if either index has no edges (and the geometries
+// do not intersect).
+//
+// This is equivalent to S2ClosestEdgeQuery::GetDistance() with an
+// S2MinDistanceShapeIndexTarget, but is much faster for large inputs.
+S1ChordAngle GetMinDistance(const S2ShapeIndex& a_index,
+                            const S2ShapeIndex& b_index,
+                            bool include_interiors = true);
+
+// Returns the maximum distance between any edge of "a_index" and any edge of
+// "b_index", or S1ChordAngle::Negative() if either index has no edges.
+// Polygon interiors are not considered.  (Note that including them can only
+// change the result if one geometry intersects the reflection of the other
+// through the origin, in which case the maximum distance is Pi.)
+S1ChordAngle GetMaxDistance(const S2ShapeIndex& a_index,
+                            const S2ShapeIndex& b_index);
+
+// A pair of edges (a, b), where "a" belongs to the first index and "b"
+// belongs to the second index.
+using ShapeEdgeIdPair = std::pair<ShapeEdgeId, ShapeEdgeId>;
+
+// Returns all pairs of edges (a, b), where "a" belongs to "a_index" and "b"
+// belongs to "b_index", such that the distance between "a" and "b" is at
+// most "max_distance".  The result is sorted and does not contain
+// duplicates.  Polygon interiors are not considered.
+std::vector<ShapeEdgeIdPair> GetEdgePairsWithinDistance(
+    const S2ShapeIndex& a_index, const S2ShapeIndex& b_index,
+    S1ChordAngle max_distance);
+
+}  // namespace s2shapeutil
+
+#endif  // S2_S2SHAPEUTIL_INDEX_DISTANCE_H_
@@ -0,0 +1,155 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2shapeutil_index_distance.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "s2/third_party/absl/memory/memory.h"
+#include "s2/mutable_s2shape_index.h"
+#include "s2/s1angle.h"
+#include "s2/s2cap.h"
+#include "s2/s2closest_edge_query.h"
+#include "s2/s2edge_distances.h"
+#include "s2/s2furthest_edge_query.h"
+#include "s2/s2loop.h"
+#include "s2/s2testing.h"
+#include "s2/s2text_format.h"
+
+using absl::make_unique;
+using std::vector;
+
+namespace s2shapeutil {
+
+// Returns the minimum distance computed by S2ClosestEdgeQuery.
+static S1ChordAngle GetQueryMinDistance(const S2ShapeIndex& a,
+                                        const S2ShapeIndex& b,
+                                        bool include_interiors) {
+  S2ClosestEdgeQuery::Options options;
+  options.set_include_interiors(include_interiors);
+  S2ClosestEdgeQuery query(&a, options);
+  S2ClosestEdgeQuery::ShapeIndexTarget target(&b);
+  target.set_include_interiors(include_interiors);
+  return query.GetDistance(&target);
+}
+
+// Returns the maximum distance between the edges of "a" and "b" computed by
+// S2FurthestEdgeQuery.
+static S1ChordAngle GetQueryMaxDistance(const S2ShapeIndex& a,
+                                        const S2ShapeIndex& b) {
+  S2FurthestEdgeQuery::Options options;
+  options.set_include_interiors(false);
+  S2FurthestEdgeQuery query(&a, options);
+  S2FurthestEdgeQuery::ShapeIndexTarget target(&b);
+  target.set_include_interiors(false);
+  return query.GetDistance(&target);
+}
+
+static vector<ShapeEdgeIdPair> GetBruteForceEdgePairs(
+    const S2ShapeIndex& a, const S2ShapeIndex& b, S1ChordAngle max_distance) {
+  vector<ShapeEdgeIdPair> result;
+  for (int i = 0; i < a.num_shape_ids(); ++i) {
+    const S2Shape* a_shape = a.shape(i);
+    for (int j = 0; j < b.num_shape_ids(); ++j) {
+      const S2Shape* b_shape = b.shape(j);
+      for (int ae = 0; ae < a_shape->num_edges(); ++ae) {
+        S2Shape::Edge a_edge = a_shape->edge(ae);
+        for (int be = 0; be < b_shape->num_edges(); ++be) {
+          S2Shape::Edge b_edge = b_shape->edge(be);
+          S1ChordAngle distance = max_distance.Successor();
+          if (S2::UpdateEdgePairMinDistance(a_edge.v0, a_edge.v1, b_edge.v0,
+                                            b_edge.v1, &distance)) {
+            result.push_back(ShapeEdgeIdPair(ShapeEdgeId(i, ae),
+                                             ShapeEdgeId(j, be)));
+          }
+        }
+      }
+    }
+  }
+  return result;
+}
+
+TEST(GetMinDistance, IncludeInteriors) {
+  // A small square inside a large square, and a point inside the small one.
+  auto a = s2textformat::MakeIndexOrDie("# # 0:0, 0:10, 10:10, 10:0");
+  auto b = s2textformat::MakeIndexOrDie("# # 4:4, 4:6, 6:6, 6:4");
+  auto c = s2textformat::MakeIndexOrDie("5:5 # #");
+  EXPECT_EQ(S1ChordAngle::Zero(), GetMinDistance(*a, *b));
+  EXPECT_EQ(S1ChordAngle::Zero(), GetMinDistance(*c, *a));
+  EXPECT_EQ(GetQueryMinDistance(*a, *b, false),
+            GetMinDistance(*a, *b, false));
+  EXPECT_NEAR(4, S1Angle(GetMinDistance(*a, *b, false)).degrees(), 0.05);
+  EXPECT_NEAR(1, S1Angle(GetMinDistance(*b, *c, false)).degrees(), 0.05);
+}
+
+TEST(GetMinDistance, EmptyIndex) {
+  MutableS2ShapeIndex empty;
+  auto a = s2textformat::MakeIndexOrDie("0:0 | 1:1 # 2:2, 3:3 #");
+  EXPECT_EQ(S1ChordAngle::Infinity(), GetMinDistance(empty, *a));
+  EXPECT_EQ(S1ChordAngle::Infinity(), GetMinDistance(*a, empty));
+  EXPECT_EQ(S1ChordAngle::Negative(), GetMaxDistance(*a, empty));
+  EXPECT_TRUE(GetEdgePairsWithinDistance(empty, *a,
+                                         S1ChordAngle::Straight()).empty());
+}
+
+TEST(GetMaxDistance, AntipodalEdges) {
+  auto a = s2textformat::MakeIndexOrDie("# 0:-10, 0:10 #");
+  auto b = s2textformat::MakeIndexOrDie("# 0:175, 0:-175 #");
+  EXPECT_EQ(S1ChordAngle::Straight(), GetMaxDistance(*a, *b));
+  auto c = s2textformat::MakeIndexOrDie("5:5 | 6:6 # #");
+  EXPECT_EQ(GetQueryMaxDistance(*a, *c), GetMaxDistance(*a, *c));
+}
+
+TEST(GetEdgePairsWithinDistance, ZeroDistance) {
+  auto a = s2textformat::MakeIndexOrDie("# 0:0, 0:10 | 5:0, 5:10 #");
+  auto b = s2textformat::MakeIndexOrDie("0:0 # -1:2, 1:2 | 3:20, 3:30 #");
+  vector<ShapeEdgeIdPair> expected = {
+    {ShapeEdgeId(0, 0), ShapeEdgeId(0, 0)},
+    {ShapeEdgeId(0, 0), ShapeEdgeId(1, 0)},
+  };
+  EXPECT_EQ(expected, GetEdgePairsWithinDistance(*a, *b,
+                                                 S1ChordAngle::Zero()));
+}
+
+TEST(IndexDistance, FractalsMatchQueries) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(300);
+  fractal.set_fractal_dimension(1.5);
+  for (int iter = 0; iter < 10; ++iter) {
+    S2Point center = S2Testing::RandomPoint();
+    S2Cap cap(center, S1Angle::Degrees(10));
+    MutableS2ShapeIndex a, b;
+    a.Add(make_unique<S2Loop::OwningShape>(fractal.MakeLoop(
+        S2Testing::GetRandomFrameAt(S2Testing::SamplePoint(cap)),
+        S1Angle::Degrees(3))));
+    b.Add(make_unique<S2Loop::OwningShape>(fractal.MakeLoop(
+        S2Testing::GetRandomFrameAt(S2Testing::SamplePoint(cap)),
+        S1Angle::Degrees(3))));
+    for (bool include_interiors : {false, true}) {
+      EXPECT_EQ(GetQueryMinDistance(a, b, include_interiors),
+                GetMinDistance(a, b, include_interiors));
+    }
+    EXPECT_EQ(GetQueryMaxDistance(a, b), GetMaxDistance(a, b));
+
+    S1ChordAngle max_distance(S1Angle::Degrees(1));
+    EXPECT_EQ(GetBruteForceEdgePairs(a, b, max_distance),
+              GetEdgePairsWithinDistance(a, b, max_distance));
+  }
+}
+
+}  // namespace s2shapeutil
@@ -40,6 +40,14 @@ void RangeIterator::SeekTo(const RangeIterator& target) {
   Refresh();
 }
 
+void RangeIterator::SeekTo(S2CellId target) {
+  it_.Seek(target);
+  // The previous cell may contain "target" even though it has a smaller
+  // S2CellId.
+  if (it_.Prev() && it_.id().range_max() < target) it_.Next();
+  Refresh();
+}
+
 void RangeIterator::SeekBeyond(const RangeIterator& target) {
   it_.Seek(target.range_max().next());
   if (!it_.done() && it_.id().range_min() <= target.range_max()) {
@@ -49,6 +49,10 @@ class RangeIterator {
   // "target", i.e. such that range_max() >= target.range_min().
   void SeekTo(const RangeIterator& target);
 
+  // Position the iterator at the first cell that contains or follows the
+  // leaf cell "target", i.e. such that range_max() >= target.
+  void SeekTo(S2CellId target);
+
   // Position the iterator at the first cell that follows "target", i.e. the
   // first cell such that range_min() > target.range_max().
   void SeekBeyond(const RangeIterator& target);
@@ -37,6 +37,19 @@ TEST(RangeIterator, Next) {
   EXPECT_TRUE(it.done());
 }
 
+TEST(RangeIterator, SeekToLeafCell) {
+  auto index = s2textformat::MakeIndex("0:0 | 0:90 | 90:0 # #");
+  RangeIterator it(*index);
+  it.SeekTo(S2CellId::FromFace(1).range_max());
+  EXPECT_EQ(1, it.id().face());
+  it.SeekTo(S2CellId::FromFace(0).range_min());
+  EXPECT_EQ(0, it.id().face());
+  it.SeekTo(S2CellId::FromFace(2).range_min());
+  EXPECT_EQ(2, it.id().face());
+  it.SeekTo(S2CellId::FromFace(3).range_min());
+  EXPECT_TRUE(it.done());
+}
+
 TEST(RangeIterator, EmptyIndex) {
   auto empty = s2textformat::MakeIndex("# #");
   auto non_empty = s2textformat::MakeIndex("0:0 # #");
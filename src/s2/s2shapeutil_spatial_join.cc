@@ -0,0 +1,402 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2shapeutil_spatial_join.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "s2/s2cell_id.h"
+#include "s2/s2closest_edge_query.h"
+#include "s2/s2contains_point_query.h"
+#include "s2/s2parallel_internal.h"
+#include "s2/s2shapeutil_shape_edge.h"
+#include "s2/s2shapeutil_shape_edge_id.h"
+#include "s2/s2shapeutil_visit_crossing_edge_pairs.h"
+#include "s2/util/gtl/btree_map.h"
+
+using std::vector;
+
+namespace s2shapeutil {
+
+SpatialJoinOptions::SpatialJoinOptions() {
+}
+
+SpatialJoinOptions::SpatialJoinOptions(SpatialPredicate predicate)
+    : predicate_(predicate) {
+}
+
+SpatialPredicate SpatialJoinOptions::predicate() const {
+  return predicate_;
+}
+
+void SpatialJoinOptions::set_predicate(SpatialPredicate predicate) {
+  predicate_ = predicate;
+}
+
+S1ChordAngle SpatialJoinOptions::max_distance() const {
+  return max_distance_;
+}
+
+void SpatialJoinOptions::set_max_distance(S1ChordAngle max_distance) {
+  max_distance_ = max_distance;
+}
+
+int SpatialJoinOptions::num_threads() const {
+  return num_threads_;
+}
+
+void SpatialJoinOptions::set_num_threads(int num_threads) {
+  S2_DCHECK_GE(num_threads, 0);
+  num_threads_ = num_threads;
+}
+
+namespace {
+
+// SpatialJoiner implements SpatialJoin() for a single pair of indexes.
+class SpatialJoiner {
+ public:
+  SpatialJoiner(const S2ShapeIndex& a_index, const S2ShapeIndex& b_index,
+                const SpatialJoinOptions& options);
+
+  vector<ShapeIdPair> Run();
+
+ private:
+  // Flags recorded for each pair of shapes whose edges cross or touch.
+  // kTouches means that an edge of "a" shares a vertex with an edge of "b",
+  // and kCrossesInterior means that the edges cross at an interior point.
+  enum : uint8 { kTouches = 1, kCrossesInterior = 2 };
+  using CrossingMap = gtl::btree_map<ShapeIdPair, uint8>;
+
+  // A polygon vertex (or point) to be tested for containment, together with
+  // its S2CellId (so that nearby points can be processed together).
+  struct ChainVertex {
+    S2CellId id;
+    int32 shape_id;
+    S2Point point;
+    bool operator<(const ChainVertex& other) const { return id < other.id; }
+  };
+
+  // A function that processes the items [begin, end) of some work list and
+  // appends any resulting shape pairs to "output".
+  using RangeFunction =
+      std::function<void (int begin, int end, vector<ShapeIdPair>* output)>;
+
+  // Calls "fn" for a set of disjoint ranges that cover [0, n) using up to
+  // num_threads_ threads, and appends the output of all calls to "pairs".
+  void ParallelFor(int n, const RangeFunction& fn,
+                   vector<ShapeIdPair>* pairs) const;
+
+  // Records every pair of shapes with crossing or touching edges.
+  void FindEdgeCrossings(CrossingMap* crossings) const;
+
+  // For each chain of each shape in "x_index", finds the shapes of "y_index"
+  // that contain the first vertex of that chain and appends the pairs
+  // (x_shape_id, y_shape_id) to "pairs" (reversed if "swapped" is true).  If
+  // "first_chain_only" is true then only chain 0 of each shape is used.
+  void FindContainedVertices(const S2ShapeIndex& x_index,
+                             const S2ShapeIndex& y_index, bool swapped,
+                             bool first_chain_only,
+                             vector<ShapeIdPair>* pairs) const;
+
+  // Appends every pair of shapes within max_distance() of each other to
+  // "pairs", except for the case where a polygon of B contains a shape of A
+  // (which is handled by FindContainedVertices).
+  void FindWithinDistance(vector<ShapeIdPair>* pairs) const;
+
+  // Returns true if polygon "a" contains shape "b", given that no edges of
+  // "a" and "b" cross (but they may share vertices if "touches" is true).
+  // "a_query" and "b_query" must use the SEMI_OPEN vertex model.
+  bool Contains(const S2Shape& a, const S2Shape& b, bool touches,
+                S2ContainsPointQuery<S2ShapeIndex>* a_query,
+                S2ContainsPointQuery<S2ShapeIndex>* b_query) const;
+
+  // Returns a point of the given edge that is not a vertex of "shape", unless
+  // both endpoints are vertices of "shape" in which case the edge midpoint
+  // is returned.  "query" must be a query over the index containing "shape".
+  static S2Point GetTestPoint(const S2Shape::Edge& edge, const S2Shape& shape,
+                              S2ContainsPointQuery<S2ShapeIndex>* query);
+
+  vector<ShapeIdPair> GetContainingPairs();
+
+  const S2ShapeIndex& a_index_;
+  const S2ShapeIndex& b_index_;
+  const SpatialJoinOptions& options_;
+  int num_threads_;
+};
+
+}  // namespace
+
+SpatialJoiner::SpatialJoiner(const S2ShapeIndex& a_index,
+                             const S2ShapeIndex& b_index,
+                             const SpatialJoinOptions& options)
+    : a_index_(a_index), b_index_(b_index), options_(options),
+      num_threads_(S2::internal::GetNumThreads(options.num_threads())) {
+}
+
+void SpatialJoiner::ParallelFor(int n, const RangeFunction& fn,
+                                vector<ShapeIdPair>* pairs) const {
+  // Use several chunks per thread so that the load is balanced even when
+  // some items are much more expensive than others.
+  static const int kChunksPerThread = 8;
+  if (num_threads_ == 1 || n < 2) {
+    fn(0, n, pairs);
+    return;
+  }
+  const int num_chunks = std::min(n, num_threads_ * kChunksPerThread);
+  vector<vector<ShapeIdPair>> outputs(num_chunks);
+  S2::internal::ParallelForChunks(
+      n, num_chunks, num_threads_, [&](int, int chunk, int begin, int end) {
+        fn(begin, end, &outputs[chunk]);
+      });
+  for (const auto& output : outputs) {
+    pairs->insert(pairs->end(), output.begin(), output.end());
+  }
+}
+
+void SpatialJoiner::FindEdgeCrossings(CrossingMap* crossings) const {
+  // We use the deterministic mode so that the visitor is only called from
+  // this thread and therefore does not need to be thread-safe.
+  ParallelVisitOptions options;
+  options.set_num_threads(num_threads_);
+  VisitCrossingEdgePairs(
+      a_index_, b_index_, CrossingType::ALL, options,
+      [crossings](const ShapeEdge& a, const ShapeEdge& b, bool is_interior) {
+        uint8* flags = &(*crossings)[ShapeIdPair(a.id().shape_id,
+                                                 b.id().shape_id)];
+        *flags |= is_interior ? kCrossesInterior : kTouches;
+        return true;
+      });
+}
+
+void SpatialJoiner::FindContainedVertices(const S2ShapeIndex& x_index,
+                                          const S2ShapeIndex& y_index,
+                                          bool swapped, bool first_chain_only,
+                                          vector<ShapeIdPair>* pairs) const {
+  // Sort the vertices by S2CellId so that consecutive queries visit nearby
+  // index cells.
+  vector<ChainVertex> vertices;
+  for (int s = 0; s < x_index.num_shape_ids(); ++s) {
+    const S2Shape* shape = x_index.shape(s);
+    if (shape == nullptr) continue;
+    int num_chains = shape->num_chains();
+    if (first_chain_only) num_chains = std::min(num_chains, 1);
+    for (int i = 0; i < num_chains; ++i) {
+      if (shape->chain(i).length == 0) continue;
+      S2Point p = shape->chain_edge(i, 0).v0;
+      vertices.push_back(ChainVertex{S2CellId(p), s, p});
+    }
+  }
+  std::sort(vertices.begin(), vertices.end());
+  ParallelFor(vertices.size(),
+              [&](int begin, int end, vector<ShapeIdPair>* output) {
+    auto query = MakeS2ContainsPointQuery(&y_index);
+    for (int i = begin; i < end; ++i) {
+      const ChainVertex& v = vertices[i];
+      query.VisitContainingShapes(v.point, [&](S2Shape* y_shape) {
+          output->push_back(swapped ? ShapeIdPair(y_shape->id(), v.shape_id)
+                                    : ShapeIdPair(v.shape_id, y_shape->id()));
+          return true;
+        });
+    }
+  }, pairs);
+}
+
+void SpatialJoiner::FindWithinDistance(vector<ShapeIdPair>* pairs) const {
+  int num_a_shapes = 0;  // The number of non-empty shapes in A.
+  for (const S2Shape* a_shape : a_index_) {
+    if (a_shape != nullptr && !a_shape->is_empty()) ++num_a_shapes;
+  }
+  vector<ShapeEdgeId> b_edges;
+  for (int s = 0; s < b_index_.num_shape_ids(); ++s) {
+    const S2Shape* shape = b_index_.shape(s);
+    if (shape == nullptr) continue;
+    if (shape->is_full()) {
+      // The full polygon has no edges, and it is within any distance of
+      // every non-empty shape.
+      for (const S2Shape* a_shape : a_index_) {
+        if (a_shape != nullptr && !a_shape->is_empty()) {
+          pairs->push_back(ShapeIdPair(a_shape->id(), s));
+        }
+      }
+      continue;
+    }
+    for (int e = 0; e < shape->num_edges(); ++e) {
+      b_edges.push_back(ShapeEdgeId(s, e));
+    }
+  }
+  ParallelFor(b_edges.size(),
+              [&](int begin, int end, vector<ShapeIdPair>* output) {
+    S2ClosestEdgeQuery query(&a_index_);
+    query.mutable_options()->set_inclusive_max_distance(
+        options_.max_distance());
+    query.mutable_options()->set_include_interiors(true);
+    vector<S2ClosestEdgeQuery::Result> results;
+    // The edges of each B shape are consecutive.  found[a_shape_id] is the
+    // id of the last B shape that was found to be within range of that A
+    // shape, so that each pair is reported at most once per range, and the
+    // remaining edges of a B shape are skipped once every A shape is found.
+    vector<int> found(a_index_.num_shape_ids(), -1);
+    int b_shape_id = -1, num_found = 0;
+    for (int i = begin; i < end; ++i) {
+      ShapeEdgeId id = b_edges[i];
+      if (id.shape_id != b_shape_id) {
+        b_shape_id = id.shape_id;
+        num_found = 0;
+      } else if (num_found == num_a_shapes) {
+        continue;
+      }
+      auto edge = b_index_.shape(id.shape_id)->edge(id.edge_id);
+      if (edge.v0 == edge.v1) {
+        S2ClosestEdgeQuery::PointTarget target(edge.v0);
+        query.FindClosestEdges(&target, &results);
+      } else {
+        S2ClosestEdgeQuery::EdgeTarget target(edge.v0, edge.v1);
+        query.FindClosestEdges(&target, &results);
+      }
+      for (const auto& result : results) {
+        if (found[result.shape_id()] == b_shape_id) continue;
+        found[result.shape_id()] = b_shape_id;
+        ++num_found;
+        output->push_back(ShapeIdPair(result.shape_id(), b_shape_id));
+      }
+    }
+  }, pairs);
+}
+
+S2Point SpatialJoiner::GetTestPoint(
+    const S2Shape::Edge& edge, const S2Shape& shape,
+    S2ContainsPointQuery<S2ShapeIndex>* query) {
+  auto is_vertex = [&shape, query](const S2Point& p) {
+    return !query->VisitIncidentEdges(p, [&shape](const ShapeEdge& e) {
+        return e.id().shape_id != shape.id();
+      });
+  };
+  if (!is_vertex(edge.v0)) return edge.v0;
+  if (!is_vertex(edge.v1)) return edge.v1;
+  return (edge.v0 + edge.v1).Normalize();
+}
+
+bool SpatialJoiner::Contains(
+    const S2Shape& a, const S2Shape& b, bool touches,
+    S2ContainsPointQuery<S2ShapeIndex>* a_query,
+    S2ContainsPointQuery<S2ShapeIndex>* b_query) const {
+  // Since no edges cross, each chain of "b" is either entirely inside or
+  // entirely outside "a", except possibly at shared vertices.  Furthermore
+  // if "b" is a polygon, then "a" does not contain "b" if any chain of "a" is
+  // inside "b" (e.g., "b" contains a hole of "a").
+  if (!touches) {
+    // It is sufficient to test one vertex of each chain.
+    for (int i = 0; i < b.num_chains(); ++i) {
+      if (b.chain(i).length == 0) continue;
+      if (!a_query->ShapeContains(a, b.chain_edge(i, 0).v0)) return false;
+    }
+    if (b.dimension() < 2) return true;
+    for (int i = 0; i < a.num_chains(); ++i) {
+      if (a.chain(i).length == 0) continue;
+      if (b_query->ShapeContains(b, a.chain_edge(i, 0).v0)) return false;
+    }
+    return true;
+  }
+  // Otherwise a chain may leave and re-enter "a" at a shared vertex, so we
+  // test one point of every edge that is not a shared vertex.
+  for (int e = 0; e < b.num_edges(); ++e) {
+    S2Point p = GetTestPoint(b.edge(e), a, a_query);
+    if (!a_query->ShapeContains(a, p)) return false;
+  }
+  if (b.dimension() < 2) return true;
+  for (int e = 0; e < a.num_edges(); ++e) {
+    S2Point p = GetTestPoint(a.edge(e), b, b_query);
+    if (b_query->ShapeContains(b, p)) return false;
+  }
+  return true;
+}
+
+vector<ShapeIdPair> SpatialJoiner::GetContainingPairs() {
+  // The candidates are the pairs where "a" contains the first vertex of "b",
+  // and the pairs whose edges touch without crossing (since in that case
+  // the first vertex of "b" may be on the boundary of "a").
+  CrossingMap crossings;
+  FindEdgeCrossings(&crossings);
+  vector<ShapeIdPair> candidates;
+  FindContainedVertices(b_index_, a_index_, true /*swapped*/,
+                        true /*first_chain_only*/, &candidates);
+  for (const auto& entry : crossings) {
+    if (entry.second == kTouches) candidates.push_back(entry.first);
+  }
+  std::sort(candidates.begin(), candidates.end());
+  candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                   candidates.end());
+
+  vector<ShapeIdPair> result;
+  ParallelFor(candidates.size(),
+              [&](int begin, int end, vector<ShapeIdPair>* output) {
+    auto a_query = MakeS2ContainsPointQuery(&a_index_);
+    auto b_query = MakeS2ContainsPointQuery(&b_index_);
+    for (int i = begin; i < end; ++i) {
+      const ShapeIdPair& pair = candidates[i];
+      const S2Shape& a = *a_index_.shape(pair.first);
+      const S2Shape& b = *b_index_.shape(pair.second);
+      if (a.dimension() != 2 || b.num_edges() == 0) continue;
+      auto it = crossings.find(pair);
+      uint8 flags = (it == crossings.end()) ? 0 : it->second;
+      if (flags & kCrossesInterior) continue;
+      if (Contains(a, b, flags & kTouches, &a_query, &b_query)) {
+        output->push_back(pair);
+      }
+    }
+  }, &result);
+  return result;
+}
+
+vector<ShapeIdPair> SpatialJoiner::Run() {
+  vector<ShapeIdPair> result;
+  switch (options_.predicate()) {
+    case SpatialPredicate::INTERSECTS: {
+      // Shapes intersect if their edges cross or touch, or if one shape
+      // contains the first vertex of some chain of the other.
+      CrossingMap crossings;
+      FindEdgeCrossings(&crossings);
+      for (const auto& entry : crossings) result.push_back(entry.first);
+      FindContainedVertices(b_index_, a_index_, true /*swapped*/,
+                            false /*first_chain_only*/, &result);
+      FindContainedVertices(a_index_, b_index_, false /*swapped*/,
+                            false /*first_chain_only*/, &result);
+      break;
+    }
+    case SpatialPredicate::CONTAINS:
+      result = GetContainingPairs();
+      break;
+
+    case SpatialPredicate::WITHIN_DISTANCE:
+      // The distance queries also find polygons of A that contain shapes of
+      // B, but not polygons of B that contain shapes of A.
+      FindWithinDistance(&result);
+      FindContainedVertices(a_index_, b_index_, false /*swapped*/,
+                            false /*first_chain_only*/, &result);
+      break;
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+vector<ShapeIdPair> SpatialJoin(const S2ShapeIndex& a_index,
+                                const S2ShapeIndex& b_index,
+                                const SpatialJoinOptions& options) {
+  return SpatialJoiner(a_index, b_index, options).Run();
+}
+
+}  // namespace s2shapeutil
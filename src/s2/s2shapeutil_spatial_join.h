@@ -0,0 +1,102 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef S2_S2SHAPEUTIL_SPATIAL_JOIN_H_
+#define S2_S2SHAPEUTIL_SPATIAL_JOIN_H_
+
+#include <utility>
+#include <vector>
+
+#include "s2/base/integral_types.h"
+#include "s2/s1chord_angle.h"
+#include "s2/s2shape_index.h"
+
+namespace s2shapeutil {
+
+// The relationship between a shape "a" of the first index and a shape "b" of
+// the second index that is required for (a, b) to be reported by
+// SpatialJoin().
+enum class SpatialPredicate {
+  // "a" and "b" have at least one point in common, i.e. an edge of "a"
+  // crosses or shares a vertex with an edge of "b", or one shape contains a
+  // vertex of the other.  Polygon boundaries are treated as semi-open (see
+  // S2ContainsPointQuery), so shapes that touch only along a polygon
+  // boundary may or may not be reported.
+  INTERSECTS,
+
+  // "a" is a polygon (dimension 2) that contains every point of "b".  Polygon
+  // boundaries are treated as semi-open, as above.
+  CONTAINS,
+
+  // The distance between "a" and "b" (including polygon interiors) is at
+  // most max_distance().  Distances are computed with the usual accuracy of
+  // S2ClosestEdgeQuery.
+  WITHIN_DISTANCE,
+};
+
+class SpatialJoinOptions {
+ public:
+  SpatialJoinOptions();
+
+  // Convenience constructor that sets the predicate() option.
+  explicit SpatialJoinOptions(SpatialPredicate predicate);
+
+  // DEFAULT: SpatialPredicate::INTERSECTS
+  SpatialPredicate predicate() const;
+  void set_predicate(SpatialPredicate predicate);
+
+  // The maximum distance used by SpatialPredicate::WITHIN_DISTANCE.
+  //
+  // DEFAULT: S1ChordAngle::Zero()
+  S1ChordAngle max_distance() const;
+  void set_max_distance(S1ChordAngle max_distance);
+
+  // The number of threads to use.  If zero, the number of threads is
+  // determined by std::thread::hardware_concurrency().  The work is divided
+  // into contiguous S2CellId ranges (for edge crossings) or contiguous ranges
+  // of vertices and edges that are processed independently.  The result does
+  // not depend on the number of threads.  (As with ParallelVisitOptions, the
+  // default is single-threaded.)
+  //
+  // DEFAULT: 1
+  int num_threads() const;
+  void set_num_threads(int num_threads);
+
+ private:
+  SpatialPredicate predicate_ = SpatialPredicate::INTERSECTS;
+  S1ChordAngle max_distance_ = S1ChordAngle::Zero();
+  int num_threads_ = 1;
+};
+
+// A pair of shape ids (a_shape_id, b_shape_id), where the first shape belongs
+// to the first index and the second shape belongs to the second index.
+using ShapeIdPair = std::pair<int32, int32>;
+
+// Returns all pairs of shapes (a, b), where "a" belongs to "a_index" and "b"
+// belongs to "b_index", such that the given predicate holds.  The result is
+// sorted and does not contain duplicates.
+//
+// This is much faster than testing each pair of shapes separately (e.g. with
+// S2BooleanOperation::Intersects), since the edges of both indexes are
+// matched up using a single synchronized traversal of their index cells (see
+// s2shapeutil::VisitCrossingEdgePairs), and the remaining containment and
+// distance tests are batched by index rather than by shape.
+std::vector<ShapeIdPair> SpatialJoin(const S2ShapeIndex& a_index,
+                                     const S2ShapeIndex& b_index,
+                                     const SpatialJoinOptions& options);
+
+}  // namespace s2shapeutil
+
+#endif  // S2_S2SHAPEUTIL_SPATIAL_JOIN_H_
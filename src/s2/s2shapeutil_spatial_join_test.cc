@@ -0,0 +1,162 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2shapeutil_spatial_join.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "s2/third_party/absl/memory/memory.h"
+#include "s2/mutable_s2shape_index.h"
+#include "s2/s1angle.h"
+#include "s2/s2boolean_operation.h"
+#include "s2/s2cap.h"
+#include "s2/s2closest_edge_query.h"
+#include "s2/s2loop.h"
+#include "s2/s2testing.h"
+#include "s2/s2text_format.h"
+
+using absl::make_unique;
+using std::unique_ptr;
+using std::vector;
+
+namespace s2shapeutil {
+
+// Index A contains two squares.  Index B contains (in order) a polyline that
+// crosses the first square, a polyline inside the second square, a distant
+// polyline, a square inside the first square, a square containing the first
+// square, and a triangle that touches the first square at one vertex.
+static const char kIndexA[] =
+    "# # 0:0, 0:10, 10:10, 10:0 | 20:20, 20:30, 30:30, 30:20";
+static const char kIndexB[] =
+    "# 5:-5, 5:5 | 25:22, 25:28 | 40:40, 41:41 # "
+    "2:2, 2:3, 3:3, 3:2 | -1:-1, -1:11, 11:11, 11:-1 | 0:10, 0:15, 5:15";
+
+static vector<ShapeIdPair> Join(SpatialPredicate predicate,
+                                S1ChordAngle max_distance = S1ChordAngle()) {
+  auto a_index = s2textformat::MakeIndexOrDie(kIndexA);
+  auto b_index = s2textformat::MakeIndexOrDie(kIndexB);
+  SpatialJoinOptions options(predicate);
+  options.set_max_distance(max_distance);
+  return SpatialJoin(*a_index, *b_index, options);
+}
+
+TEST(SpatialJoin, Intersects) {
+  vector<ShapeIdPair> expected = {{0, 0}, {0, 3}, {0, 4}, {0, 5}, {1, 1}};
+  EXPECT_EQ(expected, Join(SpatialPredicate::INTERSECTS));
+}
+
+TEST(SpatialJoin, Contains) {
+  vector<ShapeIdPair> expected = {{0, 3}, {1, 1}};
+  EXPECT_EQ(expected, Join(SpatialPredicate::CONTAINS));
+}
+
+TEST(SpatialJoin, WithinDistance) {
+  vector<ShapeIdPair> expected = {{0, 0}, {0, 3}, {0, 4}, {0, 5}, {1, 1}};
+  EXPECT_EQ(expected, Join(SpatialPredicate::WITHIN_DISTANCE,
+                           S1ChordAngle::Zero()));
+  // The distant polyline and the large square are both within 15 degrees of
+  // the second square of index A.
+  expected.push_back({1, 2});
+  expected.push_back({1, 4});
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(expected, Join(SpatialPredicate::WITHIN_DISTANCE,
+                           S1ChordAngle::Degrees(15)));
+}
+
+TEST(SpatialJoin, WithinDistanceFullPolygon) {
+  // The full polygon has no edges, but it is within any distance of every
+  // non-empty shape (including another full polygon).
+  auto a_index = s2textformat::MakeIndexOrDie(kIndexA);
+  auto full = s2textformat::MakeIndexOrDie("# # full");
+  SpatialJoinOptions options(SpatialPredicate::WITHIN_DISTANCE);
+  vector<ShapeIdPair> expected = {{0, 0}, {1, 0}};
+  EXPECT_EQ(expected, SpatialJoin(*a_index, *full, options));
+  expected = {{0, 0}};
+  EXPECT_EQ(expected, SpatialJoin(*full, *full, options));
+}
+
+TEST(SpatialJoin, EmptyIndexes) {
+  MutableS2ShapeIndex empty;
+  auto a_index = s2textformat::MakeIndexOrDie(kIndexA);
+  for (auto predicate : {SpatialPredicate::INTERSECTS,
+                         SpatialPredicate::CONTAINS,
+                         SpatialPredicate::WITHIN_DISTANCE}) {
+    SpatialJoinOptions options(predicate);
+    EXPECT_TRUE(SpatialJoin(empty, empty, options).empty());
+    EXPECT_TRUE(SpatialJoin(*a_index, empty, options).empty());
+    EXPECT_TRUE(SpatialJoin(empty, *a_index, options).empty());
+  }
+}
+
+// Adds "num_loops" random regular loops within "cap" to "index", and also
+// returns a separate single-shape index for each loop.
+static vector<unique_ptr<MutableS2ShapeIndex>> AddRandomLoops(
+    const S2Cap& cap, int num_loops, MutableS2ShapeIndex* index) {
+  vector<unique_ptr<MutableS2ShapeIndex>> shape_indexes;
+  for (int i = 0; i < num_loops; ++i) {
+    S1Angle radius = cap.GetRadius() * S2Testing::rnd.RandDouble() * 0.3;
+    int num_vertices = 4 + S2Testing::rnd.Uniform(40);
+    S2Point center = S2Testing::SamplePoint(cap);
+    index->Add(make_unique<S2Loop::OwningShape>(
+        S2Loop::MakeRegularLoop(center, radius, num_vertices)));
+    shape_indexes.push_back(make_unique<MutableS2ShapeIndex>());
+    shape_indexes.back()->Add(make_unique<S2Loop::OwningShape>(
+        S2Loop::MakeRegularLoop(center, radius, num_vertices)));
+  }
+  return shape_indexes;
+}
+
+TEST(SpatialJoin, RandomLoopsMatchPairwiseTests) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  const S1ChordAngle kMaxDistance(S1Angle::Degrees(0.5));
+  for (int iter = 0; iter < 5; ++iter) {
+    S2Cap cap(S2Testing::RandomPoint(), S1Angle::Degrees(5));
+    MutableS2ShapeIndex a_index, b_index;
+    auto a_shapes = AddRandomLoops(cap, 20, &a_index);
+    auto b_shapes = AddRandomLoops(cap, 20, &b_index);
+    vector<ShapeIdPair> intersects, contains, within_distance;
+    for (int a = 0; a < a_shapes.size(); ++a) {
+      for (int b = 0; b < b_shapes.size(); ++b) {
+        if (S2BooleanOperation::Intersects(*a_shapes[a], *b_shapes[b])) {
+          intersects.push_back(ShapeIdPair(a, b));
+        }
+        if (S2BooleanOperation::Contains(*a_shapes[a], *b_shapes[b])) {
+          contains.push_back(ShapeIdPair(a, b));
+        }
+        S2ClosestEdgeQuery query(a_shapes[a].get());
+        S2ClosestEdgeQuery::ShapeIndexTarget target(b_shapes[b].get());
+        if (query.IsDistanceLessOrEqual(&target, kMaxDistance)) {
+          within_distance.push_back(ShapeIdPair(a, b));
+        }
+      }
+    }
+    for (int num_threads : {1, 3}) {
+      SpatialJoinOptions options;
+      options.set_num_threads(num_threads);
+      options.set_max_distance(kMaxDistance);
+      options.set_predicate(SpatialPredicate::INTERSECTS);
+      EXPECT_EQ(intersects, SpatialJoin(a_index, b_index, options));
+      options.set_predicate(SpatialPredicate::CONTAINS);
+      EXPECT_EQ(contains, SpatialJoin(a_index, b_index, options));
+      options.set_predicate(SpatialPredicate::WITHIN_DISTANCE);
+      EXPECT_EQ(within_distance, SpatialJoin(a_index, b_index, options));
+    }
+  }
+}
+
+}  // namespace s2shapeutil
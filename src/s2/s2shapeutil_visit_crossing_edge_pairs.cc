@@ -17,9 +17,22 @@
 
 #include "s2/s2shapeutil_visit_crossing_edge_pairs.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include "s2/base/mutex.h"
+#include "s2/s2coords.h"
 #include "s2/s2crossing_edge_query.h"
 #include "s2/s2edge_crosser.h"
 #include "s2/s2error.h"
+#include "s2/s2parallel_internal.h"
 #include "s2/s2shapeutil_range_iterator.h"
 #include "s2/s2wedge_relations.h"
 
@@ -132,6 +145,89 @@ bool VisitCrossingEdgePairs(const S2ShapeIndex& index, CrossingType type,
 
 //////////////////////////////////////////////////////////////////////
 
+namespace {
+// EdgeBounds stores a bounding rectangle for each edge in a ShapeEdgeVector,
+// expressed in the (u,v) coordinates of a given cube face.  This is used to
+// quickly discard most edge pairs that cannot cross before testing them with
+// S2EdgeCrosser.  Since geodesics project to straight lines under the
+// gnomonic projection, the bounding rectangle of an edge whose endpoints are
+// both on the face hemisphere is simply the bound of its projected endpoints.
+// Edges that extend far beyond the face are given an unbounded rectangle.
+//
+// The rectangles are stored as separate arrays of coordinates (rather than a
+// vector of R2Rects) so that the overlap tests in FindOverlaps() can be
+// vectorized by the compiler.
+class EdgeBounds {
+ public:
+  void Init(int face, const ShapeEdgeVector& edges);
+
+  // Sets (*overlaps)[j] to 1 if the bound of edge "j" may intersect the bound
+  // of edge "i" of "other", and 0 otherwise.
+  void FindOverlaps(const EdgeBounds& other, int i,
+                    vector<uint8>* overlaps) const;
+
+ private:
+  // Returns false if "p" is not within the region of the face where its
+  // (u,v) coordinates can be computed accurately.
+  static bool GetUV(int face, const S2Point& p, double* u, double* v);
+
+  void Add(double u_lo, double u_hi, double v_lo, double v_hi);
+
+  vector<double> u_lo_, u_hi_, v_lo_, v_hi_;
+};
+}  // namespace
+
+inline bool EdgeBounds::GetUV(int face, const S2Point& p,
+                              double* u, double* v) {
+  // We only use points whose (u,v) coordinates are at most 2 in absolute
+  // value, so that a small absolute error bound suffices (see Init).
+  if (p.DotProd(S2::GetNorm(face)) <= 0) return false;
+  S2::ValidFaceXYZtoUV(face, p, u, v);
+  return std::fabs(*u) <= 2 && std::fabs(*v) <= 2;
+}
+
+inline void EdgeBounds::Add(double u_lo, double u_hi,
+                            double v_lo, double v_hi) {
+  u_lo_.push_back(u_lo);
+  u_hi_.push_back(u_hi);
+  v_lo_.push_back(v_lo);
+  v_hi_.push_back(v_hi);
+}
+
+void EdgeBounds::Init(int face, const ShapeEdgeVector& edges) {
+  // Each (u,v) coordinate is computed using a single division of two values
+  // whose magnitude is at most 2, so the error is at most DBL_EPSILON.  We
+  // use a slightly larger margin for safety.
+  static const double kMargin = 4 * DBL_EPSILON;
+  static const double kInf = std::numeric_limits<double>::infinity();
+  u_lo_.clear();
+  u_hi_.clear();
+  v_lo_.clear();
+  v_hi_.clear();
+  for (const ShapeEdge& edge : edges) {
+    double u0, v0, u1, v1;
+    if (GetUV(face, edge.v0(), &u0, &v0) && GetUV(face, edge.v1(), &u1, &v1)) {
+      Add(std::min(u0, u1) - kMargin, std::max(u0, u1) + kMargin,
+          std::min(v0, v1) - kMargin, std::max(v0, v1) + kMargin);
+    } else {
+      Add(-kInf, kInf, -kInf, kInf);
+    }
+  }
+}
+
+inline void EdgeBounds::FindOverlaps(const EdgeBounds& other, int i,
+                                     vector<uint8>* overlaps) const {
+  const double u_lo = other.u_lo_[i], u_hi = other.u_hi_[i];
+  const double v_lo = other.v_lo_[i], v_hi = other.v_hi_[i];
+  const int n = u_lo_.size();
+  overlaps->resize(n);
+  uint8* out = overlaps->data();
+  for (int j = 0; j < n; ++j) {
+    out[j] = (u_lo_[j] <= u_hi) & (u_hi_[j] >= u_lo) &
+             (v_lo_[j] <= v_hi) & (v_hi_[j] >= v_lo);
+  }
+}
+
 // IndexCrosser is a helper class for finding the edge crossings between a
 // pair of S2ShapeIndexes.  It is instantiated twice, once for the index pair
 // (A,B) and once for the index pair (B,A), in order to be able to test edge
@@ -155,9 +251,10 @@ class IndexCrosser {
   // Advances both iterators past ai->id().
   bool VisitCrossings(RangeIterator* ai, RangeIterator* bi);
 
-  // Given two index cells, visits all crossings between edges of those cells.
-  // Terminates early and returns false if visitor_ returns false.
-  bool VisitCellCellCrossings(const S2ShapeIndexCell& a_cell,
+  // Given two index cells with the same S2CellId "id", visits all crossings
+  // between edges of those cells.  Terminates early and returns false if
+  // visitor_ returns false.
+  bool VisitCellCellCrossings(S2CellId id, const S2ShapeIndexCell& a_cell,
                               const S2ShapeIndexCell& b_cell);
 
  private:
@@ -174,7 +271,8 @@ class IndexCrosser {
   bool VisitSubcellCrossings(const S2ShapeIndexCell& a_cell, S2CellId b_id);
 
   // Visits all crossings of any edge in "a_edges" with any edge in "b_edges".
-  bool VisitEdgesEdgesCrossings(const ShapeEdgeVector& a_edges,
+  // "face" is the cube face of the index cell that the edges were taken from.
+  bool VisitEdgesEdgesCrossings(int face, const ShapeEdgeVector& a_edges,
                                 const ShapeEdgeVector& b_edges);
 
   const S2ShapeIndex& a_index_;
@@ -188,6 +286,9 @@ class IndexCrosser {
   vector<const S2ShapeIndexCell*> b_cells_;
   ShapeEdgeVector a_shape_edges_;
   ShapeEdgeVector b_shape_edges_;
+  EdgeBounds a_bounds_;
+  EdgeBounds b_bounds_;
+  vector<uint8> b_overlaps_;
 };
 }  // namespace
 
@@ -240,12 +341,28 @@ bool IndexCrosser::VisitSubcellCrossings(const S2ShapeIndexCell& a_cell,
   return true;
 }
 
-bool IndexCrosser::VisitEdgesEdgesCrossings(const ShapeEdgeVector& a_edges,
+bool IndexCrosser::VisitEdgesEdgesCrossings(int face,
+                                            const ShapeEdgeVector& a_edges,
                                             const ShapeEdgeVector& b_edges) {
-  // Test all edges of "a_edges" against all edges of "b_edges".
-  for (const ShapeEdge& a : a_edges) {
+  // Test all edges of "a_edges" against all edges of "b_edges".  If there
+  // are many edge pairs, we first discard the pairs whose (u,v) bounding
+  // rectangles do not intersect.  Computing the bounds costs about as much as
+  // testing a few edge pairs, so this is not worthwhile for small inputs.
+  static const int kMinPairsToPrune = 24;
+  const bool prune =
+      a_edges.size() * b_edges.size() >= kMinPairsToPrune;
+  if (prune) {
+    a_bounds_.Init(face, a_edges);
+    b_bounds_.Init(face, b_edges);
+  }
+  const int num_a_edges = a_edges.size(), num_b_edges = b_edges.size();
+  for (int i = 0; i < num_a_edges; ++i) {
+    const ShapeEdge& a = a_edges[i];
+    if (prune) b_bounds_.FindOverlaps(a_bounds_, i, &b_overlaps_);
     S2EdgeCrosser crosser(&a.v0(), &a.v1());
-    for (const ShapeEdge& b : b_edges) {
+    for (int j = 0; j < num_b_edges; ++j) {
+      if (prune && !b_overlaps_[j]) continue;
+      const ShapeEdge& b = b_edges[j];
       if (crosser.c() == nullptr || *crosser.c() != b.v0()) {
         crosser.RestartAt(&b.v0());
       }
@@ -259,11 +376,12 @@ bool IndexCrosser::VisitEdgesEdgesCrossings(const ShapeEdgeVector& a_edges,
 }
 
 inline bool IndexCrosser::VisitCellCellCrossings(
-    const S2ShapeIndexCell& a_cell, const S2ShapeIndexCell& b_cell) {
+    S2CellId id, const S2ShapeIndexCell& a_cell,
+    const S2ShapeIndexCell& b_cell) {
   // Test all edges of "a_cell" against all edges of "b_cell".
   GetShapeEdges(a_index_, a_cell, &a_shape_edges_);
   GetShapeEdges(b_index_, b_cell, &b_shape_edges_);
-  return VisitEdgesEdgesCrossings(a_shape_edges_, b_shape_edges_);
+  return VisitEdgesEdgesCrossings(id.face(), a_shape_edges_, b_shape_edges_);
 }
 
 bool IndexCrosser::VisitCrossings(RangeIterator* ai, RangeIterator* bi) {
@@ -298,7 +416,8 @@ bool IndexCrosser::VisitCrossings(RangeIterator* ai, RangeIterator* bi) {
       // Test all the edge crossings directly.
       GetShapeEdges(a_index_, ai->cell(), &a_shape_edges_);
       GetShapeEdges(b_index_, b_cells_, &b_shape_edges_);
-      if (!VisitEdgesEdgesCrossings(a_shape_edges_, b_shape_edges_)) {
+      if (!VisitEdgesEdgesCrossings(ai->id().face(), a_shape_edges_,
+                                    b_shape_edges_)) {
         return false;
       }
     }
@@ -307,9 +426,15 @@ bool IndexCrosser::VisitCrossings(RangeIterator* ai, RangeIterator* bi) {
   return true;
 }
 
-bool VisitCrossingEdgePairs(const S2ShapeIndex& a_index,
-                            const S2ShapeIndex& b_index,
-                            CrossingType type, const EdgePairVisitor& visitor) {
+// Visits all pairs of crossing edges between A and B that are found by
+// processing the overlapping index cells whose range_min() is in the leaf
+// cell range [first, limit).  This covers every overlapping cell pair exactly
+// once when the leaf cell space is divided into disjoint ranges, and visits
+// crossings in the same order as processing the whole space at once.
+static bool VisitCrossingsInRange(
+    const S2ShapeIndex& a_index, const S2ShapeIndex& b_index,
+    CrossingType type, const EdgePairVisitor& visitor,
+    S2CellId first, S2CellId limit) {
   // We look for S2CellId ranges where the indexes of A and B overlap, and
   // then test those edges for crossings.
 
@@ -318,7 +443,23 @@ bool VisitCrossingEdgePairs(const S2ShapeIndex& a_index,
   RangeIterator ai(a_index), bi(b_index);
   IndexCrosser ab(a_index, b_index, type, visitor, false);  // Tests A against B
   IndexCrosser ba(b_index, a_index, type, visitor, true);   // Tests B against A
-  while (!ai.done() || !bi.done()) {
+  ai.SeekTo(first);
+  bi.SeekTo(first);
+  // A cell that starts before "first" and extends into this range has already
+  // been processed (together with all the cells it overlaps) as part of the
+  // range that contains its range_min().  If both current cells start before
+  // "first" then one contains the other, and we skip the larger one.
+  if (ai.range_min() < first || bi.range_min() < first) {
+    const bool skip_a = (ai.range_min() < bi.range_min() ||
+                         (ai.range_min() == bi.range_min() &&
+                          ai.range_max() > bi.range_max()));
+    const RangeIterator skipped = skip_a ? ai : bi;
+    ai.SeekBeyond(skipped);
+    bi.SeekBeyond(skipped);
+  }
+  // Note that if done() is true then range_min() is S2CellId::Sentinel(),
+  // which is not less than any "limit".
+  while (ai.range_min() < limit || bi.range_min() < limit) {
     if (ai.range_max() < bi.range_min()) {
       // The A and B cells don't overlap, and A precedes B.
       ai.SeekTo(bi);
@@ -337,7 +478,9 @@ bool VisitCrossingEdgePairs(const S2ShapeIndex& a_index,
       } else {
         // The A and B cells are the same.
         if (ai.cell().num_edges() > 0 && bi.cell().num_edges() > 0) {
-          if (!ab.VisitCellCellCrossings(ai.cell(), bi.cell())) return false;
+          if (!ab.VisitCellCellCrossings(ai.id(), ai.cell(), bi.cell())) {
+            return false;
+          }
         }
         ai.Next();
         bi.Next();
@@ -347,6 +490,14 @@ bool VisitCrossingEdgePairs(const S2ShapeIndex& a_index,
   return true;
 }
 
+bool VisitCrossingEdgePairs(const S2ShapeIndex& a_index,
+                            const S2ShapeIndex& b_index,
+                            CrossingType type, const EdgePairVisitor& visitor) {
+  return VisitCrossingsInRange(a_index, b_index, type, visitor,
+                               S2CellId::Begin(S2CellId::kMaxLevel),
+                               S2CellId::Sentinel());
+}
+
 //////////////////////////////////////////////////////////////////////
 
 // Helper function that formats a loop error message.  If the loop belongs to
@@ -437,4 +588,319 @@ bool FindSelfIntersection(const S2ShapeIndex& index, S2Error* error) {
       });
 }
 
+//////////////////////////////////////////////////////////////////////
+
+ParallelVisitOptions::ParallelVisitOptions() {
+}
+
+int ParallelVisitOptions::num_threads() const {
+  return num_threads_;
+}
+
+void ParallelVisitOptions::set_num_threads(int num_threads) {
+  S2_DCHECK_GE(num_threads, 0);
+  num_threads_ = num_threads;
+}
+
+bool ParallelVisitOptions::deterministic() const {
+  return deterministic_;
+}
+
+void ParallelVisitOptions::set_deterministic(bool deterministic) {
+  deterministic_ = deterministic;
+}
+
+namespace {
+// ParallelChunks divides the leaf cells of the S2CellId space into contiguous
+// ranges ("chunks") that each contain approximately the same number of index
+// cells from a given set of S2ShapeIndexes, and runs a worker function on a
+// set of threads that process those chunks.  Chunks are handed out to threads
+// dynamically in S2CellId order, which balances the load even when the edges
+// are concentrated in a small part of the index.
+class ParallelChunks {
+ public:
+  ParallelChunks(std::initializer_list<const S2ShapeIndex*> indexes,
+                 int num_threads);
+
+  int num_chunks() const { return chunk_firsts_.size(); }
+
+  // Chunk "i" consists of the leaf cells in the range [first(i), limit(i)).
+  S2CellId first(int chunk) const { return chunk_firsts_[chunk]; }
+  S2CellId limit(int chunk) const {
+    return chunk + 1 < num_chunks() ? chunk_firsts_[chunk + 1]
+                                    : S2CellId::Sentinel();
+  }
+
+  // Returns the next chunk to be processed, or -1 if all chunks have been
+  // handed out.  May be called concurrently from any thread.
+  int NextChunk();
+
+  // Runs "worker" on "num_threads" threads.  If "use_caller" is true, one of
+  // these threads is the calling thread and Start() returns once all workers
+  // have finished.  Otherwise "num_threads" new threads are started, Start()
+  // returns immediately, and the caller must eventually call Join().
+  void Start(const std::function<void ()>& worker, bool use_caller);
+  void Join();
+
+ private:
+  // The maximum number of chunks per thread.  Using several chunks per thread
+  // improves load balancing at the cost of slightly more seeking.
+  static constexpr int kChunksPerThread = 8;
+
+  const int num_threads_;
+  vector<S2CellId> chunk_firsts_;
+  std::atomic<int> next_chunk_;
+  vector<std::thread> threads_;
+};
+}  // namespace
+
+ParallelChunks::ParallelChunks(
+    std::initializer_list<const S2ShapeIndex*> indexes, int num_threads)
+    : num_threads_(num_threads), next_chunk_(0) {
+  // Note that iterating over the index also brings a MutableS2ShapeIndex up
+  // to date before any worker threads are started.
+  vector<S2CellId> range_mins;
+  for (const S2ShapeIndex* index : indexes) {
+    for (S2ShapeIndex::Iterator it(index, S2ShapeIndex::BEGIN);
+         !it.done(); it.Next()) {
+      range_mins.push_back(it.id().range_min());
+    }
+  }
+  if (indexes.size() > 1) std::sort(range_mins.begin(), range_mins.end());
+  int num_chunks = std::min<int>(range_mins.size(),
+                                 num_threads * kChunksPerThread);
+  for (int i = 0; i < num_chunks; ++i) {
+    chunk_firsts_.push_back(range_mins[i * range_mins.size() / num_chunks]);
+  }
+  if (num_chunks > 0) chunk_firsts_[0] = S2CellId::Begin(S2CellId::kMaxLevel);
+}
+
+inline int ParallelChunks::NextChunk() {
+  int chunk = next_chunk_.fetch_add(1, std::memory_order_relaxed);
+  return chunk < num_chunks() ? chunk : -1;
+}
+
+void ParallelChunks::Start(const std::function<void ()>& worker,
+                           bool use_caller) {
+  for (int i = use_caller ? 1 : 0; i < num_threads_; ++i) {
+    threads_.emplace_back(worker);
+  }
+  if (use_caller) {
+    worker();
+    Join();
+  }
+}
+
+void ParallelChunks::Join() {
+  for (auto& thread : threads_) thread.join();
+  threads_.clear();
+}
+
+// Returns the number of threads to use for the given options.
+static int GetNumThreads(const ParallelVisitOptions& options) {
+  return S2::internal::GetNumThreads(options.num_threads());
+}
+
+// Like VisitCrossings(index, ...) above, but only visits the index cells whose
+// range_min() is in the leaf cell range [first, limit).
+static bool VisitCrossingsInRange(
+    const S2ShapeIndex& index, CrossingType type, bool need_adjacent,
+    const EdgePairVisitor& visitor, S2CellId first, S2CellId limit) {
+  ShapeEdgeVector shape_edges;
+  S2ShapeIndex::Iterator it(&index);
+  it.Seek(first);
+  if (!it.done() && it.id().range_min() < first) it.Next();
+  for (; !it.done() && it.id().range_min() < limit; it.Next()) {
+    GetShapeEdges(index, it.cell(), &shape_edges);
+    if (!VisitCrossings(shape_edges, type, need_adjacent, visitor)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace {
+// A function that visits the crossings in the leaf cell range [first, limit),
+// terminating early if "visitor" returns false (in which case it returns
+// false as well).
+using RangeCrossingVisitor = std::function<
+  bool (S2CellId first, S2CellId limit, const EdgePairVisitor& visitor)>;
+
+// A crossing edge pair that has been buffered by a worker thread so that it
+// can be replayed later in S2CellId order.
+struct EdgePair {
+  EdgePair(const ShapeEdge& _a, const ShapeEdge& _b, bool _is_interior)
+      : a(_a), b(_b), is_interior(_is_interior) {}
+  ShapeEdge a, b;
+  bool is_interior;
+};
+}  // namespace
+
+// Visits crossings concurrently, calling "visitor" from the worker threads.
+static bool VisitCrossingsUnordered(ParallelChunks* chunks,
+                                    const RangeCrossingVisitor& visit_range,
+                                    const EdgePairVisitor& visitor) {
+  std::atomic<bool> cancelled(false);
+  const EdgePairVisitor cancellable_visitor =
+      [&](const ShapeEdge& a, const ShapeEdge& b, bool is_interior) {
+    if (cancelled.load(std::memory_order_relaxed)) return false;
+    if (visitor(a, b, is_interior)) return true;
+    cancelled.store(true, std::memory_order_relaxed);
+    return false;
+  };
+  chunks->Start([&]() {
+      for (int chunk; (chunk = chunks->NextChunk()) >= 0; ) {
+        if (cancelled.load(std::memory_order_relaxed)) break;
+        if (!visit_range(chunks->first(chunk), chunks->limit(chunk),
+                         cancellable_visitor)) {
+          break;
+        }
+      }
+    }, true /*use_caller*/);
+  return !cancelled.load();
+}
+
+// Finds crossings on the worker threads and replays them on the calling
+// thread in the same order as the single-threaded algorithm.  Chunks are
+// replayed as soon as they (and all preceding chunks) are complete, so that
+// the worker threads can be cancelled promptly if "visitor" returns false.
+static bool VisitCrossingsOrdered(ParallelChunks* chunks,
+                                  const RangeCrossingVisitor& visit_range,
+                                  const EdgePairVisitor& visitor) {
+  const int num_chunks = chunks->num_chunks();
+  vector<vector<EdgePair>> chunk_pairs(num_chunks);
+  vector<bool> chunk_done(num_chunks, false);  // Guarded by "mutex".
+  absl::Mutex mutex;
+  absl::CondVar chunk_done_cv;
+  std::atomic<bool> cancelled(false);
+  chunks->Start([&]() {
+      for (int chunk; (chunk = chunks->NextChunk()) >= 0; ) {
+        // Once "visitor" has returned false the calling thread no longer
+        // waits for any chunks, so the remaining chunks can be skipped.
+        if (cancelled.load(std::memory_order_relaxed)) break;
+        vector<EdgePair>* pairs = &chunk_pairs[chunk];
+        visit_range(chunks->first(chunk), chunks->limit(chunk),
+                    [&](const ShapeEdge& a, const ShapeEdge& b,
+                        bool is_interior) {
+                      pairs->emplace_back(a, b, is_interior);
+                      return !cancelled.load(std::memory_order_relaxed);
+                    });
+        mutex.Lock();
+        chunk_done[chunk] = true;
+        mutex.Unlock();
+        chunk_done_cv.SignalAll();
+      }
+    }, false /*use_caller*/);
+  for (int chunk = 0; chunk < num_chunks; ++chunk) {
+    mutex.Lock();
+    while (!chunk_done[chunk]) chunk_done_cv.Wait(&mutex);
+    mutex.Unlock();
+    for (const EdgePair& pair : chunk_pairs[chunk]) {
+      if (!visitor(pair.a, pair.b, pair.is_interior)) {
+        cancelled.store(true);
+        break;
+      }
+    }
+    if (cancelled.load()) break;
+    vector<EdgePair>().swap(chunk_pairs[chunk]);  // Release memory.
+  }
+  chunks->Join();
+  return !cancelled.load();
+}
+
+static bool VisitCrossingsParallel(const ParallelVisitOptions& options,
+                                   ParallelChunks* chunks,
+                                   const RangeCrossingVisitor& visit_range,
+                                   const EdgePairVisitor& visitor) {
+  if (options.deterministic()) {
+    return VisitCrossingsOrdered(chunks, visit_range, visitor);
+  } else {
+    return VisitCrossingsUnordered(chunks, visit_range, visitor);
+  }
+}
+
+bool VisitCrossingEdgePairs(const S2ShapeIndex& index, CrossingType type,
+                            const ParallelVisitOptions& options,
+                            const EdgePairVisitor& visitor) {
+  int num_threads = GetNumThreads(options);
+  if (num_threads == 1) return VisitCrossingEdgePairs(index, type, visitor);
+
+  const bool need_adjacent = (type == CrossingType::ALL);
+  ParallelChunks chunks({&index}, num_threads);
+  return VisitCrossingsParallel(
+      options, &chunks,
+      [&](S2CellId first, S2CellId limit, const EdgePairVisitor& visitor) {
+        return VisitCrossingsInRange(index, type, need_adjacent, visitor,
+                                     first, limit);
+      }, visitor);
+}
+
+bool VisitCrossingEdgePairs(const S2ShapeIndex& a_index,
+                            const S2ShapeIndex& b_index, CrossingType type,
+                            const ParallelVisitOptions& options,
+                            const EdgePairVisitor& visitor) {
+  int num_threads = GetNumThreads(options);
+  if (num_threads == 1) {
+    return VisitCrossingEdgePairs(a_index, b_index, type, visitor);
+  }
+  ParallelChunks chunks({&a_index, &b_index}, num_threads);
+  return VisitCrossingsParallel(
+      options, &chunks,
+      [&](S2CellId first, S2CellId limit, const EdgePairVisitor& visitor) {
+        return VisitCrossingsInRange(a_index, b_index, type, visitor,
+                                     first, limit);
+      }, visitor);
+}
+
+bool FindSelfIntersection(const S2ShapeIndex& index,
+                          const ParallelVisitOptions& options,
+                          S2Error* error) {
+  int num_threads = GetNumThreads(options);
+  if (num_threads == 1) return FindSelfIntersection(index, error);
+  if (index.num_shape_ids() == 0) return false;
+  S2_DCHECK_EQ(1, index.num_shape_ids());
+  const S2Shape& shape = *index.shape(0);
+
+  // Each chunk records the first error that it finds (if any).  In
+  // deterministic mode we report the error from the first chunk that has one,
+  // which is the same error that the single-threaded algorithm would find.
+  // This means that a chunk can only be abandoned once an error has been
+  // found in some preceding chunk.  Otherwise we stop as soon as any error
+  // has been found.
+  ParallelChunks chunks({&index}, num_threads);
+  const int num_chunks = chunks.num_chunks();
+  const bool deterministic = options.deterministic();
+  vector<S2Error> chunk_errors(num_chunks);
+  std::atomic<int> error_chunk(num_chunks);
+  auto should_stop = [&](int chunk) {
+    int min_chunk = error_chunk.load(std::memory_order_relaxed);
+    return deterministic ? chunk > min_chunk : min_chunk < num_chunks;
+  };
+  chunks.Start([&]() {
+      for (int chunk; (chunk = chunks.NextChunk()) >= 0; ) {
+        if (should_stop(chunk)) break;
+        S2Error* chunk_error = &chunk_errors[chunk];
+        VisitCrossingsInRange(
+            index, CrossingType::ALL, false /*need_adjacent*/,
+            [&](const ShapeEdge& a, const ShapeEdge& b, bool is_interior) {
+              if (should_stop(chunk)) return false;
+              return !FindCrossingError(shape, a, b, is_interior,
+                                        chunk_error);
+            },
+            chunks.first(chunk), chunks.limit(chunk));
+        if (!chunk_error->ok()) {
+          // Atomically set error_chunk = min(error_chunk, chunk).
+          int min_chunk = error_chunk.load();
+          while (chunk < min_chunk &&
+                 !error_chunk.compare_exchange_weak(min_chunk, chunk)) {
+          }
+        }
+      }
+    }, true /*use_caller*/);
+  int min_chunk = error_chunk.load();
+  if (min_chunk == num_chunks) return false;
+  *error = chunk_errors[min_chunk];
+  return true;
+}
+
 }  // namespace s2shapeutil
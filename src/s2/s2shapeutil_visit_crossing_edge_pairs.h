@@ -67,6 +67,72 @@ bool VisitCrossingEdgePairs(const S2ShapeIndex& a_index,
 // duplicate vertices and edges are allowed, but loop crossings are not).
 bool FindSelfIntersection(const S2ShapeIndex& index, S2Error* error);
 
+// Options for the multi-threaded variants of VisitCrossingEdgePairs() and
+// FindSelfIntersection() below.  These variants split the index cells into
+// contiguous S2CellId ranges and process the ranges on a set of worker
+// threads.  They are only worthwhile for large indexes (e.g., millions of
+// edges); for small indexes the single-threaded versions are faster.
+class ParallelVisitOptions {
+ public:
+  ParallelVisitOptions();
+
+  // The number of worker threads to use.  If zero, the number of threads is
+  // determined by std::thread::hardware_concurrency().  A value of 1 runs the
+  // entire algorithm on the calling thread.  (Like the other multi-threaded
+  // options in this library, the default is single-threaded.)
+  //
+  // DEFAULT: 1
+  int num_threads() const;
+  void set_num_threads(int num_threads);
+
+  // If true, the EdgePairVisitor is only ever called from the calling thread,
+  // and crossings are visited in exactly the same order as the
+  // single-threaded algorithm.  (Crossings are buffered by the worker threads
+  // and then replayed in S2CellId order.)  Similarly FindSelfIntersection()
+  // reports the same error as the single-threaded version.
+  //
+  // If false, the EdgePairVisitor is called concurrently from the worker
+  // threads in an unspecified order and must therefore be thread-safe.  This
+  // avoids buffering crossings, and FindSelfIntersection() reports whichever
+  // error is found first.
+  //
+  // In both cases, once the visitor returns false no further crossings are
+  // visited and all worker threads stop as soon as possible.
+  //
+  // DEFAULT: true
+  bool deterministic() const;
+  void set_deterministic(bool deterministic);
+
+ private:
+  int num_threads_ = 1;
+  bool deterministic_ = true;
+};
+
+// Like VisitCrossingEdgePairs(index, type, visitor) above, but uses multiple
+// threads as specified by "options".  Note that unless
+// options.deterministic() is true, "visitor" must be thread-safe.
+//
+// CAVEAT: Crossings may be visited more than once.
+bool VisitCrossingEdgePairs(const S2ShapeIndex& index, CrossingType type,
+                            const ParallelVisitOptions& options,
+                            const EdgePairVisitor& visitor);
+
+// Like VisitCrossingEdgePairs(a_index, b_index, type, visitor) above, but uses
+// multiple threads as specified by "options".  Note that unless
+// options.deterministic() is true, "visitor" must be thread-safe.
+//
+// CAVEAT: Crossings may be visited more than once.
+bool VisitCrossingEdgePairs(const S2ShapeIndex& a_index,
+                            const S2ShapeIndex& b_index, CrossingType type,
+                            const ParallelVisitOptions& options,
+                            const EdgePairVisitor& visitor);
+
+// Like FindSelfIntersection(index, error) above, but uses multiple threads as
+// specified by "options".
+bool FindSelfIntersection(const S2ShapeIndex& index,
+                          const ParallelVisitOptions& options,
+                          S2Error* error);
+
 }  // namespace s2shapeutil
 
 #endif  // S2_S2SHAPEUTIL_VISIT_CROSSING_EDGE_PAIRS_H_
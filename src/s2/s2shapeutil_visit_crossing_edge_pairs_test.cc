@@ -17,12 +17,15 @@
 
 #include "s2/s2shapeutil_visit_crossing_edge_pairs.h"
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
 #include <gtest/gtest.h>
+#include "s2/base/mutex.h"
 #include "s2/third_party/absl/memory/memory.h"
 #include "s2/mutable_s2shape_index.h"
+#include "s2/s2cap.h"
 #include "s2/s2edge_crossings.h"
 #include "s2/s2edge_vector_shape.h"
 #include "s2/s2error.h"
@@ -30,6 +33,7 @@
 #include "s2/s2polygon.h"
 #include "s2/s2shapeutil_contains_brute_force.h"
 #include "s2/s2shapeutil_edge_iterator.h"
+#include "s2/s2testing.h"
 #include "s2/s2text_format.h"
 
 using absl::make_unique;
@@ -121,6 +125,55 @@ TEST(GetCrossingEdgePairs, EdgeGrid) {
   TestGetCrossingEdgePairs(index, CrossingType::INTERIOR);
 }
 
+// Returns a shape containing "num_edges" random edges within the given cap.
+static unique_ptr<S2EdgeVectorShape> MakeRandomEdges(const S2Cap& cap,
+                                                     int num_edges) {
+  auto shape = make_unique<S2EdgeVectorShape>();
+  for (int i = 0; i < num_edges; ++i) {
+    S2Point a = S2Testing::SamplePoint(cap);
+    S2Point b = S2Testing::SamplePoint(cap);
+    shape->Add(a, b);
+  }
+  return shape;
+}
+
+TEST(GetCrossingEdgePairs, TwoIndexesMatchBruteForce) {
+  // The edges are long compared to the index cells, so that the index cells
+  // contain enough edges for the bounding rectangle pruning to be used.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  for (int iter = 0; iter < 5; ++iter) {
+    S2Cap cap(S2Testing::RandomPoint(), S1Angle::Degrees(iter == 0 ? 60 : 1));
+    MutableS2ShapeIndex a_index, b_index;
+    a_index.Add(MakeRandomEdges(cap, 150));
+    b_index.Add(MakeRandomEdges(cap, 150));
+    for (CrossingType type : {CrossingType::ALL, CrossingType::INTERIOR}) {
+      int min_sign = (type == CrossingType::ALL) ? 0 : 1;
+      EdgePairVector expected;
+      for (EdgeIterator a_iter(&a_index); !a_iter.Done(); a_iter.Next()) {
+        auto a = a_iter.edge();
+        for (EdgeIterator b_iter(&b_index); !b_iter.Done(); b_iter.Next()) {
+          auto b = b_iter.edge();
+          if (S2::CrossingSign(a.v0, a.v1, b.v0, b.v1) >= min_sign) {
+            expected.push_back(std::make_pair(a_iter.shape_edge_id(),
+                                              b_iter.shape_edge_id()));
+          }
+        }
+      }
+      EdgePairVector actual;
+      VisitCrossingEdgePairs(
+          a_index, b_index, type,
+          [&actual](const ShapeEdge& a, const ShapeEdge& b, bool) {
+            actual.push_back(std::make_pair(a.id(), b.id()));
+            return true;  // Continue visiting.
+          });
+      std::sort(actual.begin(), actual.end());
+      actual.erase(std::unique(actual.begin(), actual.end()), actual.end());
+      std::sort(expected.begin(), expected.end());
+      EXPECT_EQ(expected, actual);
+    }
+  }
+}
+
 // Return true if any loop crosses any other loop (including vertex crossings
 // and duplicate edges), or any loop has a self-intersection (including
 // duplicate vertices).
@@ -181,4 +234,155 @@ TEST(FindSelfIntersection, Basic) {
                   true);  // vertex crossing
 }
 
+// Returns the crossings visited by the parallel version of
+// VisitCrossingEdgePairs, in the order that they were visited.
+EdgePairVector GetCrossingsParallel(const S2ShapeIndex& index,
+                                    CrossingType type,
+                                    const ParallelVisitOptions& options) {
+  EdgePairVector edge_pairs;
+  absl::Mutex mutex;
+  VisitCrossingEdgePairs(
+      index, type, options, [&](const ShapeEdge& a, const ShapeEdge& b, bool) {
+        mutex.Lock();
+        edge_pairs.push_back(std::make_pair(a.id(), b.id()));
+        mutex.Unlock();
+        return true;  // Continue visiting.
+      });
+  return edge_pairs;
+}
+
+// Returns an index containing a fractal loop with many edges, so that the
+// index has enough cells to be split among several threads.
+static unique_ptr<MutableS2ShapeIndex> MakeFractalIndex(int num_vertices) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(num_vertices);
+  auto loop = fractal.MakeLoop(S2Testing::GetRandomFrame(),
+                               S2Testing::KmToAngle(10));
+  auto index = make_unique<MutableS2ShapeIndex>();
+  index->Add(make_unique<S2Loop::OwningShape>(std::move(loop)));
+  return index;
+}
+
+TEST(GetCrossingEdgePairsParallel, DeterministicMatchesSequential) {
+  auto index = MakeFractalIndex(3000);
+  for (CrossingType type : {CrossingType::ALL, CrossingType::INTERIOR}) {
+    EdgePairVector expected;
+    VisitCrossingEdgePairs(
+        *index, type, [&](const ShapeEdge& a, const ShapeEdge& b, bool) {
+          expected.push_back(std::make_pair(a.id(), b.id()));
+          return true;
+        });
+    for (int num_threads : {1, 2, 4, 7}) {
+      ParallelVisitOptions options;
+      options.set_num_threads(num_threads);
+      EXPECT_EQ(expected, GetCrossingsParallel(*index, type, options));
+    }
+  }
+}
+
+TEST(GetCrossingEdgePairsParallel, UnorderedFindsAllCrossings) {
+  auto index = MakeFractalIndex(3000);
+  EdgePairVector expected = GetCrossings(*index, CrossingType::ALL);
+  ParallelVisitOptions options;
+  options.set_num_threads(4);
+  options.set_deterministic(false);
+  EdgePairVector actual =
+      GetCrossingsParallel(*index, CrossingType::ALL, options);
+  std::sort(actual.begin(), actual.end());
+  actual.erase(std::unique(actual.begin(), actual.end()), actual.end());
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(GetCrossingEdgePairsParallel, EarlyExit) {
+  auto index = MakeFractalIndex(3000);
+  for (bool deterministic : {true, false}) {
+    ParallelVisitOptions options;
+    options.set_num_threads(4);
+    options.set_deterministic(deterministic);
+    std::atomic<int> num_visited(0);
+    EXPECT_FALSE(VisitCrossingEdgePairs(
+        *index, CrossingType::ALL, options,
+        [&](const ShapeEdge& a, const ShapeEdge& b, bool) {
+          return ++num_visited < 10;
+        }));
+    if (deterministic) {
+      EXPECT_EQ(10, num_visited.load());
+    }
+  }
+}
+
+TEST(GetCrossingEdgePairsParallel, TwoIndexesMatchSequential) {
+  // Two overlapping fractals with different numbers of edges, so that cells
+  // of each index straddle the chunk boundaries of the other.
+  auto a_index = MakeFractalIndex(3000);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(300);
+  MutableS2ShapeIndex b_index;
+  b_index.Add(make_unique<S2Loop::OwningShape>(fractal.MakeLoop(
+      S2Testing::GetRandomFrameAt(a_index->shape(0)->edge(0).v0),
+      S2Testing::KmToAngle(10))));
+  for (CrossingType type : {CrossingType::ALL, CrossingType::INTERIOR}) {
+    EdgePairVector expected;
+    VisitCrossingEdgePairs(
+        *a_index, b_index, type,
+        [&](const ShapeEdge& a, const ShapeEdge& b, bool) {
+          expected.push_back(std::make_pair(a.id(), b.id()));
+          return true;
+        });
+    EXPECT_FALSE(expected.empty());
+    for (bool deterministic : {true, false}) {
+      ParallelVisitOptions options;
+      options.set_num_threads(4);
+      options.set_deterministic(deterministic);
+      EdgePairVector actual;
+      absl::Mutex mutex;
+      VisitCrossingEdgePairs(
+          *a_index, b_index, type, options,
+          [&](const ShapeEdge& a, const ShapeEdge& b, bool) {
+            mutex.Lock();
+            actual.push_back(std::make_pair(a.id(), b.id()));
+            mutex.Unlock();
+            return true;
+          });
+      if (!deterministic) {
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+      }
+      EXPECT_EQ(expected, actual);
+    }
+  }
+}
+
+TEST(FindSelfIntersectionParallel, MatchesSequential) {
+  // A large valid loop, followed by the same loop with duplicate vertices
+  // inserted at various positions.
+  auto index = MakeFractalIndex(3000);
+  const S2Shape& shape = *index->shape(0);
+  ParallelVisitOptions options;
+  options.set_num_threads(4);
+  S2Error error;
+  EXPECT_FALSE(FindSelfIntersection(*index, options, &error));
+
+  vector<S2Point> vertices;
+  for (int i = 0; i < shape.num_edges(); ++i) {
+    vertices.push_back(shape.edge(i).v0);
+  }
+  for (int dup : {100, 1500, 2900}) {
+    vertices.insert(vertices.begin() + dup + 2, vertices[dup]);
+    MutableS2ShapeIndex dup_index;
+    dup_index.Add(make_unique<S2Loop::OwningShape>(
+        make_unique<S2Loop>(vertices, S2Debug::DISABLE)));
+    S2Error expected, actual;
+    ASSERT_TRUE(FindSelfIntersection(dup_index, &expected));
+    ASSERT_TRUE(FindSelfIntersection(dup_index, options, &actual));
+    EXPECT_EQ(expected.code(), actual.code());
+    EXPECT_EQ(expected.text(), actual.text());
+
+    options.set_deterministic(false);
+    EXPECT_TRUE(FindSelfIntersection(dup_index, options, &actual));
+    options.set_deterministic(true);
+  }
+}
+
 }  // namespace s2shapeutil
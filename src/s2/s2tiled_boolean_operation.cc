@@ -0,0 +1,206 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2tiled_boolean_operation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "s2/base/mutex.h"
+#include "s2/third_party/absl/memory/memory.h"
+#include "s2/s2builderutil_s2polygon_layer.h"
+#include "s2/s2builderutil_snap_functions.h"
+#include "s2/s2edge_crossings.h"
+#include "s2/s2lax_polygon_shape.h"
+#include "s2/s2metrics.h"
+#include "s2/s2parallel_internal.h"
+
+using absl::make_unique;
+using s2builderutil::IdentitySnapFunction;
+using s2builderutil::S2PolygonLayer;
+using std::pair;
+using std::unique_ptr;
+using std::vector;
+
+S2TiledBooleanOperation::Options::Options()
+    : snap_function_(make_unique<IdentitySnapFunction>(S1Angle::Zero())) {
+}
+
+S2TiledBooleanOperation::Options::Options(
+    const S2Builder::SnapFunction& snap_function)
+    : snap_function_(snap_function.Clone()) {
+}
+
+S2TiledBooleanOperation::Options::Options(const Options& options)
+    : snap_function_(options.snap_function_->Clone()),
+      num_threads_(options.num_threads_) {
+}
+
+S2TiledBooleanOperation::Options&
+S2TiledBooleanOperation::Options::operator=(const Options& options) {
+  snap_function_ = options.snap_function_->Clone();
+  num_threads_ = options.num_threads_;
+  return *this;
+}
+
+const S2Builder::SnapFunction&
+S2TiledBooleanOperation::Options::snap_function() const {
+  return *snap_function_;
+}
+
+void S2TiledBooleanOperation::Options::set_snap_function(
+    const S2Builder::SnapFunction& snap_function) {
+  snap_function_ = snap_function.Clone();
+}
+
+int S2TiledBooleanOperation::Options::num_threads() const {
+  return num_threads_;
+}
+
+void S2TiledBooleanOperation::Options::set_num_threads(int num_threads) {
+  S2_DCHECK_GE(num_threads, 0);
+  num_threads_ = num_threads;
+}
+
+S2TiledBooleanOperation::S2TiledBooleanOperation(OpType op_type,
+                                                 const Options& options)
+    : op_type_(op_type), options_(options) {
+}
+
+bool S2TiledBooleanOperation::BuildTile(
+    S2CellId tile, const InputFunction& a, const InputFunction& b,
+    S2Polygon* result, S2Error* error) const {
+  S2Cell cell(tile);
+  MutableS2ShapeIndex a_index, b_index;
+  a(cell, &a_index);
+  b(cell, &b_index);
+  if (a_index.num_shape_ids() == 0 && b_index.num_shape_ids() == 0) {
+    return true;
+  }
+  // Clip both inputs to the tile.  No snapping is done here (other than
+  // merging computed intersection points), so that the only snapping is
+  // done by the operation itself.  The tile is represented as a lax polygon
+  // since this avoids the validation and bookkeeping done by S2Polygon.
+  vector<S2Point> tile_vertices;
+  for (int k = 0; k < 4; ++k) tile_vertices.push_back(cell.GetVertex(k));
+  MutableS2ShapeIndex tile_index;
+  tile_index.Add(make_unique<S2LaxPolygonShape>(
+      vector<S2LaxPolygonShape::Loop>{std::move(tile_vertices)}));
+  auto clip = [&tile_index, error](const S2ShapeIndex& index,
+                                   S2Polygon* clipped) {
+    if (index.num_shape_ids() == 0) return true;
+    S2BooleanOperation op(OpType::INTERSECTION,
+                          make_unique<S2PolygonLayer>(clipped));
+    return op.Build(index, tile_index, error);
+  };
+  S2Polygon a_clipped, b_clipped;
+  if (!clip(a_index, &a_clipped) || !clip(b_index, &b_clipped)) return false;
+  if (options_.snap_function().snap_radius() == S1Angle::Zero()) {
+    S2BooleanOperation op(
+        op_type_, make_unique<S2PolygonLayer>(result),
+        S2BooleanOperation::Options(options_.snap_function()));
+    return op.Build(a_clipped.index(), b_clipped.index(), error);
+  }
+  // Snapping may move edges across the tile boundary, and adjacent tiles do
+  // not necessarily snap the vertices near their shared boundary to the same
+  // locations.  We clip the snapped result to the tile again so that the
+  // results for different tiles never overlap.
+  S2Polygon snapped;
+  S2BooleanOperation op(
+      op_type_, make_unique<S2PolygonLayer>(&snapped),
+      S2BooleanOperation::Options(options_.snap_function()));
+  if (!op.Build(a_clipped.index(), b_clipped.index(), error)) return false;
+  return clip(snapped.index(), result);
+}
+
+bool S2TiledBooleanOperation::Build(
+    const vector<S2CellId>& tiles, const InputFunction& a,
+    const InputFunction& b, const OutputFunction& output, S2Error* error) {
+  error->Clear();
+  // Snapping can collapse the result within a tile that is not much wider
+  // than the snap radius, even where the untiled result would be unaffected.
+  S1Angle snap_radius = options_.snap_function().snap_radius();
+  for (S2CellId tile : tiles) {
+    if (S1Angle::Radians(S2::kMinWidth.GetValue(tile.level())) <
+        2 * snap_radius) {
+      error->Init(S2Error::INVALID_ARGUMENT,
+                  "Tile %s is narrower than twice the snap radius",
+                  tile.ToString().c_str());
+      return false;
+    }
+  }
+  // Tiles are handed out one at a time.  The remaining tiles are skipped as
+  // soon as any tile reports an error; the first such error is returned.
+  std::atomic<bool> failed(false);
+  absl::Mutex mutex;  // Protects "output" and "error".
+  S2::internal::ParallelForChunks(
+      tiles.size(), tiles.size(), options_.num_threads(),
+      [&](int, int i, int, int) {
+        if (failed.load()) return;
+        S2Error tile_error;
+        auto result = make_unique<S2Polygon>();
+        bool ok = BuildTile(tiles[i], a, b, result.get(), &tile_error);
+        mutex.Lock();
+        if (!ok) {
+          if (!failed.exchange(true)) *error = tile_error;
+        } else if (!result->is_empty() && !failed.load()) {
+          output(tiles[i], std::move(result));
+        }
+        mutex.Unlock();
+      });
+  return error->ok();
+}
+
+bool S2TiledBooleanOperation::Build(
+    const vector<S2CellId>& tiles, const InputFunction& a,
+    const InputFunction& b, S2Polygon* result, S2Error* error) {
+  vector<pair<S2CellId, unique_ptr<S2Polygon>>> pieces;
+  if (!Build(tiles, a, b,
+             [&pieces](S2CellId tile, unique_ptr<S2Polygon> piece) {
+               pieces.emplace_back(tile, std::move(piece));
+             }, error)) {
+    return false;
+  }
+  // Add the pieces in a deterministic order, since they may have been
+  // produced in any order.
+  std::sort(pieces.begin(), pieces.end(),
+            [](const pair<S2CellId, unique_ptr<S2Polygon>>& x,
+               const pair<S2CellId, unique_ptr<S2Polygon>>& y) {
+              return x.first < y.first;
+            });
+
+  // Vertices on the boundary between two tiles are computed separately for
+  // each tile, so they may differ by up to S2::kIntersectionError.  We merge
+  // them using a snap radius of at least S2::kIntersectionMergeRadius, at
+  // which point the edges along each shared tile boundary form sibling pairs
+  // that are discarded by S2PolygonLayer.  If the snap radius is larger,
+  // this step also snaps the (unsnapped) vertices on the tile boundaries.
+  // Since the S2Builder "idempotent" option is true by default, the other
+  // vertices do not move unless this is necessary.
+  unique_ptr<S2Builder::SnapFunction> snap_function;
+  if (options_.snap_function().snap_radius() >= S2::kIntersectionMergeRadius) {
+    snap_function = options_.snap_function().Clone();
+  } else {
+    snap_function =
+        make_unique<IdentitySnapFunction>(S2::kIntersectionMergeRadius);
+  }
+  S2Builder builder{S2Builder::Options(*snap_function)};
+  builder.StartLayer(make_unique<S2PolygonLayer>(result));
+  for (const auto& piece : pieces) {
+    builder.AddPolygon(*piece.second);
+  }
+  return builder.Build(error);
+}
@@ -0,0 +1,167 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef S2_S2TILED_BOOLEAN_OPERATION_H_
+#define S2_S2TILED_BOOLEAN_OPERATION_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "s2/mutable_s2shape_index.h"
+#include "s2/s2boolean_operation.h"
+#include "s2/s2builder.h"
+#include "s2/s2cell.h"
+#include "s2/s2cell_id.h"
+#include "s2/s2error.h"
+#include "s2/s2polygon.h"
+
+// S2TiledBooleanOperation evaluates a polygon boolean operation one S2Cell
+// "tile" at a time.  This is useful when the input geometry is too large to
+// be represented as a pair of S2ShapeIndexes (e.g., overlaying two
+// continent-scale datasets), since at any one time only the geometry that
+// intersects the tiles currently being processed needs to be in memory.
+// Tiles are independent and can be processed by several threads at once.
+//
+// For each tile, the client supplies the input geometry that intersects that
+// tile.  Each input region is clipped to the tile, the boolean operation is
+// applied to the clipped regions, and the result (which is contained by the
+// tile) is passed to the client.  The per-tile results can be stitched
+// together with S2Builder to obtain the result for the entire area covered
+// by the tiles; the Build() method that outputs an S2Polygon does this.
+//
+// This works because boolean operations commute with clipping, i.e. for
+// every tile T, OP(A, B) intersected with T is OP(A ∩ T, B ∩ T).  The
+// results for adjacent tiles share the tile boundary, which the stitching
+// step discards (as sibling edge pairs) after merging the boundary vertices
+// computed separately by each tile.
+//
+// Snapping does not commute with clipping, however.  The vertices chosen by
+// S2Builder depend on the other vertices nearby, so adjacent tiles may snap
+// geometry near their shared boundary differently, and snapping can move
+// edges across the boundary.  Each tile's snapped result is therefore
+// clipped to the tile again.  This means that the vertices where the result
+// crosses a tile boundary are not snapped, and the results for adjacent
+// tiles may not match exactly along their shared boundary.  (The Build()
+// method that outputs an S2Polygon snaps these vertices while stitching.)
+// The stitched result differs from the exact result OP(A, B) only within
+// 2 * snap_function().max_edge_deviation() of the exact result's boundary,
+// compared with max_edge_deviation() for the untiled operation.  With a
+// zero snap radius (the default) the tiled and untiled results are the same
+// up to the merging of boundary vertices.
+//
+// Only polygonal geometry is supported.  As with S2BooleanOperation, the
+// polygons within each input region must have disjoint interiors.
+//
+// Example usage:
+//
+//   S2TiledBooleanOperation op(S2BooleanOperation::OpType::INTERSECTION);
+//   vector<S2CellId> tiles = ...;  // E.g., a covering at a fixed level.
+//   auto land_cover = [&](const S2Cell& tile, MutableS2ShapeIndex* index) {
+//     // Load the land cover polygons that intersect "tile" into "index".
+//   };
+//   auto admin_areas = ...;
+//   S2Error error;
+//   bool ok = op.Build(tiles, land_cover, admin_areas,
+//                      [&](S2CellId tile, std::unique_ptr<S2Polygon> result) {
+//                        // Write "result" to disk.
+//                      }, &error);
+class S2TiledBooleanOperation {
+ public:
+  using OpType = S2BooleanOperation::OpType;
+
+  // A function that adds every input polygon that intersects "tile" to
+  // "index".  The polygons do not need to be clipped to the tile, although
+  // memory usage is bounded only if they are not much larger than the tile.
+  // If num_threads() > 1 this function may be called concurrently from
+  // several threads (with a different tile and index each time).
+  using InputFunction =
+      std::function<void(const S2Cell& tile, MutableS2ShapeIndex* index)>;
+
+  // A function that receives the result of the operation restricted to
+  // "tile".  It is called only for tiles where the result is non-empty.
+  // Calls are never concurrent, but tiles may be delivered in any order.
+  using OutputFunction =
+      std::function<void(S2CellId tile, std::unique_ptr<S2Polygon> result)>;
+
+  class Options {
+   public:
+    Options();
+
+    // Convenience constructor that calls set_snap_function().
+    explicit Options(const S2Builder::SnapFunction& snap_function);
+
+    // Specifies the function to be used for snap rounding the result of the
+    // operation in each tile (see S2BooleanOperation::Options).  Note that
+    // the vertices where the result crosses a tile boundary are not snapped
+    // (see the class comment).
+    //
+    // DEFAULT: s2builderutil::IdentitySnapFunction(S1Angle::Zero())
+    const S2Builder::SnapFunction& snap_function() const;
+    void set_snap_function(const S2Builder::SnapFunction& snap_function);
+
+    // The number of threads used to process tiles.  If zero, the number of
+    // threads is determined by std::thread::hardware_concurrency().
+    //
+    // DEFAULT: 1
+    int num_threads() const;
+    void set_num_threads(int num_threads);
+
+    // Options may be assigned and copied.
+    Options(const Options& options);
+    Options& operator=(const Options& options);
+
+   private:
+    std::unique_ptr<S2Builder::SnapFunction> snap_function_;
+    int num_threads_ = 1;
+  };
+
+  explicit S2TiledBooleanOperation(OpType op_type,
+                                   const Options& options = Options());
+
+  OpType op_type() const { return op_type_; }
+  const Options& options() const { return options_; }
+
+  // Evaluates the operation for each of the given tiles and passes each
+  // non-empty result to "output".  Returns true on success, and otherwise
+  // sets "error" appropriately (in which case some tiles may not have been
+  // processed).
+  //
+  // REQUIRES: The tiles do not overlap (e.g., they are the cells of a
+  //           normalized S2CellUnion).
+  //
+  // Returns an INVALID_ARGUMENT error if any tile is narrower than twice the
+  // snap radius, since snapping could then collapse the result within that
+  // tile even where the untiled result is unaffected.
+  bool Build(const std::vector<S2CellId>& tiles, const InputFunction& a,
+             const InputFunction& b, const OutputFunction& output,
+             S2Error* error);
+
+  // Convenience method that stitches the results for all tiles together and
+  // stores them in "result".  Note that the entire result is held in memory.
+  bool Build(const std::vector<S2CellId>& tiles, const InputFunction& a,
+             const InputFunction& b, S2Polygon* result, S2Error* error);
+
+ private:
+  // Computes the result of the operation within the given tile.
+  bool BuildTile(S2CellId tile, const InputFunction& a,
+                 const InputFunction& b, S2Polygon* result,
+                 S2Error* error) const;
+
+  OpType op_type_;
+  Options options_;
+};
+
+#endif  // S2_S2TILED_BOOLEAN_OPERATION_H_
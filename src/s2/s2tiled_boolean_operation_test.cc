@@ -0,0 +1,211 @@
+// Copyright 2019 Google Inc. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS-IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "s2/s2tiled_boolean_operation.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "s2/third_party/absl/memory/memory.h"
+#include "s2/s1angle.h"
+#include "s2/s2builderutil_s2polygon_layer.h"
+#include "s2/s2builderutil_snap_functions.h"
+#include "s2/s2cap.h"
+#include "s2/s2closest_edge_query.h"
+#include "s2/s2loop.h"
+#include "s2/s2region_coverer.h"
+#include "s2/s2testing.h"
+#include "s2/s2text_format.h"
+
+using absl::make_unique;
+using std::unique_ptr;
+using std::vector;
+using OpType = S2BooleanOperation::OpType;
+
+namespace {
+
+// Returns an InputFunction that adds "polygon" to the index for every tile
+// that it may intersect.
+S2TiledBooleanOperation::InputFunction PolygonInput(const S2Polygon& polygon) {
+  return [&polygon](const S2Cell& tile, MutableS2ShapeIndex* index) {
+    if (polygon.MayIntersect(tile)) {
+      index->Add(make_unique<S2Polygon::Shape>(&polygon));
+    }
+  };
+}
+
+// Returns the cells at the given level that cover "a" and "b".
+vector<S2CellId> GetTiles(const S2Polygon& a, const S2Polygon& b, int level) {
+  S2RegionCoverer::Options options;
+  options.set_fixed_level(level);
+  S2RegionCoverer coverer(options);
+  S2CellUnion tiles = coverer.GetCovering(a);
+  tiles = tiles.Union(coverer.GetCovering(b));
+  vector<S2CellId> result;
+  tiles.Denormalize(level, 1, &result);
+  return result;
+}
+
+void ExpectTiledResultEquals(OpType op_type, const S2Polygon& a,
+                             const S2Polygon& b, int level,
+                             const S2TiledBooleanOperation::Options& options) {
+  SCOPED_TRACE(S2BooleanOperation::OpTypeToString(op_type));
+  S2Polygon expected;
+  S2BooleanOperation op(
+      op_type, make_unique<s2builderutil::S2PolygonLayer>(&expected),
+      S2BooleanOperation::Options(options.snap_function()));
+  S2Error error;
+  ASSERT_TRUE(op.Build(a.index(), b.index(), &error)) << error;
+
+  S2TiledBooleanOperation tiled_op(op_type, options);
+  S2Polygon actual;
+  ASSERT_TRUE(tiled_op.Build(GetTiles(a, b, level), PolygonInput(a),
+                             PolygonInput(b), &actual, &error)) << error;
+  EXPECT_TRUE(actual.IsValid());
+  // Vertices where edges cross tile boundaries may be snapped differently
+  // than the corresponding edges in the untiled result.
+  S1Angle tolerance = 2 * options.snap_function().snap_radius() +
+                      S1Angle::Radians(1e-13);
+  EXPECT_TRUE(expected.ApproxEquals(&actual, tolerance))
+      << "\nExpected: " << s2textformat::ToString(expected)
+      << "\nActual:   " << s2textformat::ToString(actual);
+}
+
+// Checks the error bound for a nonzero snap radius: every point further than
+// 2 * max_edge_deviation() from the boundary of the exact result is contained
+// by the tiled result if and only if it is contained by the exact result.
+void ExpectTiledResultNear(OpType op_type, const S2Polygon& a,
+                           const S2Polygon& b, int level,
+                           const S2TiledBooleanOperation::Options& options) {
+  SCOPED_TRACE(S2BooleanOperation::OpTypeToString(op_type));
+  S2Polygon exact;
+  S2BooleanOperation op(
+      op_type, make_unique<s2builderutil::S2PolygonLayer>(&exact));
+  S2Error error;
+  ASSERT_TRUE(op.Build(a.index(), b.index(), &error)) << error;
+
+  S2TiledBooleanOperation tiled_op(op_type, options);
+  S2Polygon actual;
+  ASSERT_TRUE(tiled_op.Build(GetTiles(a, b, level), PolygonInput(a),
+                             PolygonInput(b), &actual, &error)) << error;
+  EXPECT_TRUE(actual.IsValid());
+  S1ChordAngle max_error(2 * options.snap_function().max_edge_deviation());
+  S2ClosestEdgeQuery query(&exact.index());
+  S2Cap cap = a.GetCapBound().Union(b.GetCapBound());
+  for (int i = 0; i < 1000; ++i) {
+    S2Point p = S2Testing::SamplePoint(cap);
+    S2ClosestEdgeQuery::PointTarget target(p);
+    if (query.IsDistanceLess(&target, max_error)) continue;
+    EXPECT_EQ(exact.Contains(p), actual.Contains(p));
+  }
+}
+
+void ExpectAllOpsMatch(const S2Polygon& a, const S2Polygon& b, int level,
+                       const S2TiledBooleanOperation::Options& options) {
+  for (OpType op_type : {OpType::UNION, OpType::INTERSECTION,
+                         OpType::DIFFERENCE, OpType::SYMMETRIC_DIFFERENCE}) {
+    ExpectTiledResultEquals(op_type, a, b, level, options);
+  }
+}
+
+TEST(S2TiledBooleanOperation, OverlappingSquares) {
+  auto a = s2textformat::MakePolygonOrDie("0:0, 0:10, 10:10, 10:0");
+  auto b = s2textformat::MakePolygonOrDie(
+      "5:5, 5:15, 15:15, 15:5; 7:7, 13:7, 13:13, 7:13");
+  ExpectAllOpsMatch(*a, *b, 5, S2TiledBooleanOperation::Options());
+}
+
+TEST(S2TiledBooleanOperation, FractalLoopsInParallel) {
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(300);
+  fractal.set_fractal_dimension(1.4);
+  for (int iter = 0; iter < 3; ++iter) {
+    Matrix3x3_d frame = S2Testing::GetRandomFrame();
+    S2Polygon a(fractal.MakeLoop(frame, S1Angle::Degrees(10)));
+    S2Point offset = S2Testing::SamplePoint(
+        S2Cap(frame.Col(2), S1Angle::Degrees(8)));
+    S2Polygon b(fractal.MakeLoop(S2Testing::GetRandomFrameAt(offset),
+                                 S1Angle::Degrees(10)));
+    S2TiledBooleanOperation::Options options;
+    options.set_num_threads(3);
+    ExpectAllOpsMatch(a, b, 4, options);
+  }
+}
+
+TEST(S2TiledBooleanOperation, SmallSnapRadius) {
+  auto a = s2textformat::MakePolygonOrDie("0:0, 0:10, 10:10, 10:0");
+  auto b = s2textformat::MakePolygonOrDie("3.3:-5.1, 3.3:15.7, 8.2:4.4");
+  S2TiledBooleanOperation::Options options(
+      s2builderutil::IntLatLngSnapFunction(5));
+  ExpectAllOpsMatch(*a, *b, 6, options);
+}
+
+TEST(S2TiledBooleanOperation, LargeSnapRadius) {
+  // The snap radius (about 0.7 degrees) is a significant fraction of the tile
+  // width (at least 1.7 degrees), so many vertices and edges are snapped
+  // across tile boundaries.
+  S2Testing::rnd.Reset(FLAGS_s2_random_seed);
+  S2Testing::Fractal fractal;
+  fractal.SetLevelForApproxMaxEdges(300);
+  S2TiledBooleanOperation::Options options(
+      s2builderutil::IntLatLngSnapFunction(0));
+  for (int iter = 0; iter < 3; ++iter) {
+    Matrix3x3_d frame = S2Testing::GetRandomFrame();
+    S2Polygon a(fractal.MakeLoop(frame, S1Angle::Degrees(10)));
+    S2Point offset = S2Testing::SamplePoint(
+        S2Cap(frame.Col(2), S1Angle::Degrees(8)));
+    S2Polygon b(fractal.MakeLoop(S2Testing::GetRandomFrameAt(offset),
+                                 S1Angle::Degrees(10)));
+    for (OpType op_type : {OpType::UNION, OpType::INTERSECTION,
+                           OpType::DIFFERENCE,
+                           OpType::SYMMETRIC_DIFFERENCE}) {
+      ExpectTiledResultNear(op_type, a, b, 5, options);
+    }
+  }
+}
+
+TEST(S2TiledBooleanOperation, TilesNarrowerThanSnapRadius) {
+  auto a = s2textformat::MakePolygonOrDie("0:0, 0:10, 10:10, 10:0");
+  auto b = s2textformat::MakePolygonOrDie("3.3:-5.1, 3.3:15.7, 8.2:4.4");
+  S2TiledBooleanOperation op(
+      OpType::UNION, S2TiledBooleanOperation::Options(
+          s2builderutil::IntLatLngSnapFunction(0)));
+  S2Polygon result;
+  S2Error error;
+  EXPECT_FALSE(op.Build(GetTiles(*a, *b, 7), PolygonInput(*a),
+                        PolygonInput(*b), &result, &error));
+  EXPECT_EQ(S2Error::INVALID_ARGUMENT, error.code());
+}
+
+TEST(S2TiledBooleanOperation, OutputFunctionReceivesNonEmptyTiles) {
+  auto a = s2textformat::MakePolygonOrDie("0:0, 0:10, 10:10, 10:0");
+  auto b = s2textformat::MakePolygonOrDie("20:20, 20:30, 30:30, 30:20");
+  vector<S2CellId> tiles = GetTiles(*a, *b, 4);
+  S2TiledBooleanOperation op(OpType::UNION);
+  vector<S2CellId> output_tiles;
+  S2Error error;
+  ASSERT_TRUE(op.Build(tiles, PolygonInput(*a), PolygonInput(*b),
+                       [&](S2CellId tile, unique_ptr<S2Polygon> result) {
+                         EXPECT_FALSE(result->is_empty());
+                         EXPECT_TRUE(S2Polygon(S2Cell(tile)).ApproxContains(
+                             result.get(), S1Angle::Radians(1e-13)));
+                         output_tiles.push_back(tile);
+                       }, &error)) << error;
+  EXPECT_FALSE(output_tiles.empty());
+}
+
+}  // namespace